@@ -0,0 +1,88 @@
+#include "clip.h"
+
+#include <algorithm>
+#include <cmath>
+
+Clip::Clip()
+    : _name{"No name given"}, _start_time{0.0f}, _end_time{0.0f},
+      _looping{true} {}
+
+TransformTrack& Clip::operator[](unsigned int joint) {
+    for (TransformTrack& track : _tracks) {
+        if (track.id() == joint) {
+            return track;
+        }
+    }
+
+    _tracks.emplace_back();
+    _tracks.back().set_id(joint);
+    return _tracks.back();
+}
+
+const TransformTrack* Clip::find_track(unsigned int joint) const {
+    for (const TransformTrack& track : _tracks) {
+        if (track.id() == joint) {
+            return &track;
+        }
+    }
+    return nullptr;
+}
+
+float Clip::sample(Pose& out, float time, const JointMask* mask) const {
+    if (duration() == 0.0f) {
+        return 0.0f;
+    }
+
+    time = adjust_time_to_fit_range(time);
+    for (const TransformTrack& track : _tracks) {
+        unsigned int joint = track.id();
+        if (mask && !(*mask)[joint]) {
+            continue;
+        }
+
+        Transform local = out.local_transform(joint);
+        out.set_local_transform(joint, track.sample(local, time, _looping));
+    }
+    return time;
+}
+
+float Clip::adjust_time_to_fit_range(float time) const {
+    float duration = this->duration();
+    if (duration <= 0.0f) {
+        return 0.0f;
+    }
+
+    if (_looping) {
+        time = std::fmod(time - _start_time, duration);
+        if (time < 0.0f) {
+            time += duration;
+        }
+        return time + _start_time;
+    }
+
+    return std::clamp(time, _start_time, _end_time);
+}
+
+void Clip::recalculate_duration() {
+    _start_time = 0.0f;
+    _end_time = 0.0f;
+    bool start_set = false;
+    bool end_set = false;
+
+    for (const TransformTrack& track : _tracks) {
+        if (!track.is_valid()) {
+            continue;
+        }
+
+        float start = track.start_time();
+        float end = track.end_time();
+        if (start < _start_time || !start_set) {
+            _start_time = start;
+            start_set = true;
+        }
+        if (end > _end_time || !end_set) {
+            _end_time = end;
+            end_set = true;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "event_track.h"
+#include "pose.h"
+#include "transform_track.h"
+
+using JointMask = std::vector<uint8_t>;
+
+class Clip {
+public:
+    Clip();
+
+    const std::string& name() const { return _name; }
+    void set_name(const std::string& name) { _name = name; }
+
+    bool looping() const { return _looping; }
+    void set_looping(bool looping) { _looping = looping; }
+
+    float start_time() const { return _start_time; }
+    float end_time() const { return _end_time; }
+    float duration() const { return _end_time - _start_time; }
+
+    unsigned int size() const {
+        return static_cast<unsigned int>(_tracks.size());
+    }
+    unsigned int joint_id(unsigned int index) const {
+        return _tracks[index].id();
+    }
+    TransformTrack& track(unsigned int index) { return _tracks[index]; }
+    const TransformTrack& track(unsigned int index) const {
+        return _tracks[index];
+    }
+
+    TransformTrack& operator[](unsigned int joint);
+    const TransformTrack* find_track(unsigned int joint) const;
+
+    EventTrack& events() { return _events; }
+    const EventTrack& events() const { return _events; }
+
+    float sample(Pose& out, float time,
+                 const JointMask* mask = nullptr) const;
+    float adjust_time_to_fit_range(float time) const;
+    void recalculate_duration();
+
+private:
+    std::string _name;
+    std::vector<TransformTrack> _tracks;
+    EventTrack _events;
+    float _start_time;
+    float _end_time;
+    bool _looping;
+};
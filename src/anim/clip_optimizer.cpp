@@ -0,0 +1,243 @@
+#include "clip_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../math/transform.h"
+
+namespace {
+
+Vec3 interpolate(const Vec3& a, const Vec3& b, float t) {
+    return lerp(a, b, t);
+}
+
+Quat interpolate(const Quat& a, const Quat& b, float t) {
+    if (dot(a, b) < 0.0f) {
+        return nlerp(a, -b, t);
+    }
+    return nlerp(a, b, t);
+}
+
+Vec3 frame_value(const VectorFrame& frame) {
+    return Vec3(frame.value[0], frame.value[1], frame.value[2]);
+}
+
+Quat frame_value(const QuaternionFrame& frame) {
+    return normalized(Quat(frame.value[0], frame.value[1], frame.value[2],
+                           frame.value[3]));
+}
+
+float rotation_error(const Quat& a, const Quat& b) {
+    float chord = std::sqrt(std::min(len_sq(a - b), len_sq(a + b)));
+    return chord * std::sqrt(std::max(4.0f - chord * chord, 0.0f));
+}
+
+float vector_error(const Vec3& a, const Vec3& b) {
+    return std::sqrt(len_sq(a - b));
+}
+
+float value_error(const Vec3& a, const Vec3& b) { return vector_error(a, b); }
+float value_error(const Quat& a, const Quat& b) { return rotation_error(a, b); }
+
+template <typename T, unsigned int N>
+bool segment_fits(const Track<T, N>& track, unsigned int first,
+                  unsigned int last, float tolerance) {
+    const Frame<N>& a = track[first];
+    const Frame<N>& b = track[last];
+    float span = b.time - a.time;
+    T va = frame_value(a);
+    T vb = frame_value(b);
+
+    for (unsigned int k = first + 1; k < last; ++k) {
+        T expected = frame_value(track[k]);
+        T actual = va;
+        if (track.interpolation() == Interpolation::Linear && span > 0.0f) {
+            actual = interpolate(va, vb, (track[k].time - a.time) / span);
+        }
+        if (value_error(expected, actual) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, unsigned int N>
+void reduce_track(const Track<T, N>& in, Track<T, N>& out, float tolerance) {
+    out = in;
+    unsigned int size = in.size();
+    if (size <= 2 || in.interpolation() == Interpolation::Cubic) {
+        return;
+    }
+
+    std::vector<unsigned int> kept;
+    kept.push_back(0);
+    unsigned int anchor = 0;
+    for (unsigned int i = 2; i < size; ++i) {
+        if (!segment_fits(in, anchor, i, tolerance)) {
+            anchor = i - 1;
+            kept.push_back(anchor);
+        }
+    }
+    kept.push_back(size - 1);
+
+    out.resize(static_cast<unsigned int>(kept.size()));
+    for (unsigned int i = 0; i < kept.size(); ++i) {
+        out[i] = in[kept[i]];
+    }
+}
+
+template <typename T, unsigned int N>
+unsigned int track_bytes(const Track<T, N>& track) {
+    return track.size() * static_cast<unsigned int>(sizeof(Frame<N>));
+}
+
+unsigned int clip_keys(const Clip& clip) {
+    unsigned int keys = 0;
+    for (unsigned int i = 0; i < clip.size(); ++i) {
+        const TransformTrack& track = clip.track(i);
+        keys += track.position().size() + track.rotation().size() +
+                track.scale().size();
+    }
+    return keys;
+}
+
+unsigned int clip_bytes(const Clip& clip) {
+    unsigned int bytes = 0;
+    for (unsigned int i = 0; i < clip.size(); ++i) {
+        const TransformTrack& track = clip.track(i);
+        bytes += track_bytes(track.position()) +
+                 track_bytes(track.rotation()) + track_bytes(track.scale());
+    }
+    return bytes;
+}
+
+constexpr unsigned int MAX_ATTEMPTS = 8;
+
+float max_component(const Vec3& v) {
+    return std::max(std::abs(v.x), std::max(std::abs(v.y), std::abs(v.z)));
+}
+
+void reduce_clip(const Clip& source, const Pose& rest,
+                 const std::vector<Transform>& globals,
+                 const std::vector<float>& levers, float joint_budget,
+                 const ClipOptimizerSettings& settings, Clip& out) {
+    unsigned int num_joints = rest.size();
+
+    out = source;
+    for (unsigned int i = 0; i < source.size(); ++i) {
+        const TransformTrack& in_track = source.track(i);
+        TransformTrack& out_track = out.track(i);
+        unsigned int joint = in_track.id();
+
+        float parent_scale = 1.0f;
+        float lever = settings.shell_distance;
+        if (joint < num_joints) {
+            int parent = rest.parent(joint);
+            if (parent >= 0) {
+                parent_scale = std::max(max_component(globals[parent].scale),
+                                        VEC3_EPSILON);
+            }
+            lever = levers[joint];
+        }
+
+        reduce_track(in_track.position(), out_track.position(),
+                     joint_budget / parent_scale);
+        reduce_track(in_track.rotation(), out_track.rotation(),
+                     joint_budget / (lever * parent_scale));
+        reduce_track(in_track.scale(), out_track.scale(),
+                     joint_budget / (lever * parent_scale));
+    }
+    out.recalculate_duration();
+}
+
+} // namespace
+
+ClipOptimizerResult optimize_clip(const Clip& source, const Skeleton& skeleton,
+                                  const ClipOptimizerSettings& settings,
+                                  Clip& out) {
+    const Pose& rest = skeleton.rest_pose();
+    unsigned int num_joints = rest.size();
+
+    std::vector<Transform> globals(num_joints);
+    std::vector<unsigned int> depths(num_joints, 0);
+    unsigned int max_depth = 0;
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        globals[i] = rest.global_transform(i);
+        for (int p = rest.parent(i); p >= 0; p = rest.parent(p)) {
+            ++depths[i];
+        }
+        max_depth = std::max(max_depth, depths[i]);
+    }
+
+    // 关节的旋转/缩放误差以它到最远子孙（外加包围壳）的距离为力臂放大。
+    std::vector<float> levers(num_joints, settings.shell_distance);
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        for (int p = rest.parent(i); p >= 0; p = rest.parent(p)) {
+            float distance = vector_error(globals[i].position,
+                                          globals[p].position) +
+                             settings.shell_distance;
+            levers[p] = std::max(levers[p], distance);
+        }
+    }
+
+    float joint_budget = settings.max_error /
+                         (3.0f * static_cast<float>(max_depth + 1));
+
+    // 容差分配只是估计，插值误差叠加后仍可能超出上限，
+    // 实测超出时减半重来，几次都不行就保留原始关键帧。
+    ClipOptimizerResult result;
+    bool fits = false;
+    for (unsigned int attempt = 0; attempt < MAX_ATTEMPTS && !fits;
+         ++attempt) {
+        reduce_clip(source, rest, globals, levers, joint_budget, settings,
+                    out);
+        result.max_error = measure_clip_error(source, out, skeleton,
+                                              settings.validate_sample_rate);
+        fits = result.max_error <= settings.max_error;
+        joint_budget *= 0.5f;
+    }
+    if (!fits) {
+        out = source;
+        result.max_error = 0.0f;
+    }
+
+    result.source_keys = clip_keys(source);
+    result.optimized_keys = clip_keys(out);
+    result.source_bytes = clip_bytes(source);
+    result.optimized_bytes = clip_bytes(out);
+    if (result.optimized_bytes > 0) {
+        result.compression_ratio = static_cast<float>(result.source_bytes) /
+                                   static_cast<float>(result.optimized_bytes);
+    }
+    return result;
+}
+
+float measure_clip_error(const Clip& reference, const Clip& clip,
+                         const Skeleton& skeleton, float sample_rate) {
+    float duration = reference.duration();
+    if (duration <= 0.0f || sample_rate <= 0.0f) {
+        return 0.0f;
+    }
+
+    Pose expected = skeleton.rest_pose();
+    Pose actual = skeleton.rest_pose();
+    unsigned int num_samples =
+        static_cast<unsigned int>(std::ceil(duration * sample_rate)) + 1;
+
+    float max_error = 0.0f;
+    for (unsigned int s = 0; s < num_samples; ++s) {
+        float time = std::min(reference.start_time() +
+                                  static_cast<float>(s) / sample_rate,
+                              reference.end_time());
+        reference.sample(expected, time);
+        clip.sample(actual, time);
+
+        for (unsigned int j = 0; j < expected.size(); ++j) {
+            Vec3 a = expected.global_transform(j).position;
+            Vec3 b = actual.global_transform(j).position;
+            max_error = std::max(max_error, vector_error(a, b));
+        }
+    }
+    return max_error;
+}
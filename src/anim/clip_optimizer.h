@@ -0,0 +1,29 @@
+#pragma once
+
+#include "clip.h"
+#include "skeleton.h"
+
+struct ClipOptimizerSettings {
+    float max_error = 0.001f;
+    float shell_distance = 0.1f;
+    float validate_sample_rate = 120.0f;
+};
+
+struct ClipOptimizerResult {
+    unsigned int source_keys = 0;
+    unsigned int optimized_keys = 0;
+    unsigned int source_bytes = 0;
+    unsigned int optimized_bytes = 0;
+    float compression_ratio = 1.0f;
+    float max_error = 0.0f;
+};
+
+// 离线工具：删除不影响世界空间关节位置（误差上限内）的关键帧。
+// 每个关节的局部误差按层级传播到其所有子孙，容差按骨链深度平均分配。
+// 结果的 max_error 不会超过 settings.max_error，做不到时 out 就是 source。
+ClipOptimizerResult optimize_clip(const Clip& source, const Skeleton& skeleton,
+                                  const ClipOptimizerSettings& settings,
+                                  Clip& out);
+
+float measure_clip_error(const Clip& reference, const Clip& clip,
+                         const Skeleton& skeleton, float sample_rate);
@@ -0,0 +1,31 @@
+#include "clip_player.h"
+
+ClipPlayer::ClipPlayer()
+    : _clip{nullptr}, _root_motion{nullptr}, _time{0.0f}, _prev_time{0.0f},
+      _step{0.0f}, _speed{1.0f} {}
+
+void ClipPlayer::set_clip(const Clip* clip, const RootMotion* root_motion) {
+    _clip = clip;
+    _root_motion = root_motion;
+    _time = clip ? clip->start_time() : 0.0f;
+    _prev_time = _time;
+    _step = 0.0f;
+    _root_motion_delta = RootMotionDelta();
+}
+
+void ClipPlayer::update(Pose& pose, float dt, const JointMask* mask) {
+    if (!_clip) {
+        return;
+    }
+
+    float step = dt * _speed;
+    if (_root_motion && !_root_motion->empty()) {
+        _root_motion_delta = _root_motion->delta(_time, step);
+    } else {
+        _root_motion_delta = RootMotionDelta();
+    }
+
+    _prev_time = _time;
+    _step = step;
+    _time = _clip->sample(pose, _time + step, mask);
+}
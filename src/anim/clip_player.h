@@ -0,0 +1,47 @@
+#pragma once
+
+#include "clip.h"
+#include "pose.h"
+#include "root_motion.h"
+
+class ClipPlayer {
+public:
+    ClipPlayer();
+
+    void set_clip(const Clip* clip, const RootMotion* root_motion = nullptr);
+    const Clip* clip() const { return _clip; }
+
+    float time() const { return _time; }
+    void set_time(float time) { _time = time; }
+
+    float speed() const { return _speed; }
+    void set_speed(float speed) { _speed = speed; }
+
+    void update(Pose& pose, float dt, const JointMask* mask = nullptr);
+
+    const RootMotionDelta& root_motion_delta() const {
+        return _root_motion_delta;
+    }
+
+    template <typename F>
+    void for_each_event(F&& fn) const;
+
+private:
+    const Clip* _clip;
+    const RootMotion* _root_motion;
+    float _time;
+    float _prev_time;
+    float _step;
+    float _speed;
+    RootMotionDelta _root_motion_delta;
+};
+
+template <typename F>
+void ClipPlayer::for_each_event(F&& fn) const {
+    if (!_clip) {
+        return;
+    }
+
+    _clip->events().query(_prev_time, _step, _clip->start_time(),
+                          _clip->end_time(), _clip->looping(), fn);
+}
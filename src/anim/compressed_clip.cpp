@@ -0,0 +1,666 @@
+#include "compressed_clip.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "../math/transform.h"
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANIM_COMPRESSED_CLIP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(Transform) == 10 * sizeof(float),
+              "pose decompression writes transforms as packed floats");
+
+namespace {
+
+constexpr uint32_t POSITION_OFFSET = 0;
+constexpr uint32_t ROTATION_OFFSET = 3;
+constexpr uint32_t SCALE_OFFSET = 7;
+constexpr uint32_t TRANSFORM_FLOATS = 10;
+
+constexpr float QUANTIZE_SCALE = 65535.0f;
+constexpr float SMALLEST_THREE_RANGE = 0.70710678f;
+constexpr float SMALLEST_THREE_SCALE = 32767.0f;
+
+struct ConstantScalar {
+    uint32_t dest;
+    float value;
+};
+
+struct ConstantRotation {
+    uint32_t joint;
+    float value[4];
+};
+
+struct AnimatedScalar {
+    uint32_t dest;
+    float min;
+    float extent;
+};
+
+uint32_t align_up(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+const T* at(const CompressedClipHeader* header, uint32_t offset) {
+    return reinterpret_cast<const T*>(
+        reinterpret_cast<const uint8_t*>(header) + offset);
+}
+
+template <typename T>
+T* at(uint8_t* base, uint32_t offset) {
+    return reinterpret_cast<T*>(base + offset);
+}
+
+uint64_t align_up64(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// 表必须完整落在块内并按元素对齐，数量来自文件，乘法用 64 位以免溢出。
+bool table_in_range(const CompressedClipHeader& header, uint32_t offset,
+                    uint64_t count, uint64_t element_size,
+                    uint64_t alignment) {
+    return offset % alignment == 0 && offset <= header.total_size &&
+           count * element_size <= header.total_size - offset;
+}
+
+// 采样时按这里检查过的范围直接写入 pose，不再逐项检查。
+bool validate(const CompressedClipHeader& header) {
+    uint64_t scalar_stride = align_up64(header.num_animated_scalars, 8);
+    uint64_t rotation_stride = align_up64(header.num_animated_rotations, 8);
+    uint64_t frame_size = (scalar_stride + 3 * rotation_stride) *
+                          sizeof(uint16_t);
+    if (header.total_size < sizeof(CompressedClipHeader) ||
+        header.num_samples < 2 || header.frame_stride < frame_size ||
+        header.frame_stride % alignof(uint16_t) != 0 ||
+        !table_in_range(header, header.constant_scalar_offset,
+                        header.num_constant_scalars, sizeof(ConstantScalar),
+                        alignof(ConstantScalar)) ||
+        !table_in_range(header, header.animated_scalar_offset,
+                        scalar_stride * 3, sizeof(uint32_t),
+                        alignof(uint32_t)) ||
+        !table_in_range(header, header.constant_rotation_offset,
+                        header.num_constant_rotations,
+                        sizeof(ConstantRotation), alignof(ConstantRotation)) ||
+        !table_in_range(header, header.animated_rotation_offset,
+                        rotation_stride, sizeof(uint32_t),
+                        alignof(uint32_t)) ||
+        !table_in_range(header, header.samples_offset, header.num_samples,
+                        header.frame_stride, alignof(uint16_t))) {
+        return false;
+    }
+
+    uint64_t num_floats =
+        static_cast<uint64_t>(header.num_joints) * TRANSFORM_FLOATS;
+    const ConstantScalar* constant_scalars =
+        at<ConstantScalar>(&header, header.constant_scalar_offset);
+    for (uint32_t i = 0; i < header.num_constant_scalars; ++i) {
+        if (constant_scalars[i].dest >= num_floats) {
+            return false;
+        }
+    }
+    const uint32_t* dests =
+        at<uint32_t>(&header, header.animated_scalar_offset);
+    for (uint32_t i = 0; i < header.num_animated_scalars; ++i) {
+        if (dests[i] >= num_floats) {
+            return false;
+        }
+    }
+    const ConstantRotation* constant_rotations =
+        at<ConstantRotation>(&header, header.constant_rotation_offset);
+    for (uint32_t i = 0; i < header.num_constant_rotations; ++i) {
+        if (constant_rotations[i].joint >= header.num_joints) {
+            return false;
+        }
+    }
+    const uint32_t* joints =
+        at<uint32_t>(&header, header.animated_rotation_offset);
+    for (uint32_t i = 0; i < header.num_animated_rotations; ++i) {
+        if (joints[i] >= header.num_joints) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float rotation_error(const Quat& a, const Quat& b) {
+    Quat q = normalized(b);
+    return std::sqrt(std::min(len_sq(a - q), len_sq(a + q)));
+}
+
+uint16_t quantize(float value, float min, float extent) {
+    if (extent <= 0.0f) {
+        return 0;
+    }
+    float normalized = std::clamp((value - min) / extent, 0.0f, 1.0f);
+    return static_cast<uint16_t>(std::lround(normalized * QUANTIZE_SCALE));
+}
+
+void encode_rotation(const Quat& rotation, uint16_t& a, uint16_t& b,
+                     uint16_t& c) {
+    Quat q = normalized(rotation);
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < 4; ++i) {
+        if (std::abs(q.v[i]) > std::abs(q.v[largest])) {
+            largest = i;
+        }
+    }
+    if (q.v[largest] < 0.0f) {
+        q = -q;
+    }
+
+    uint16_t packed[3];
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        float normalized = (q.v[i] + SMALLEST_THREE_RANGE) /
+                           (2.0f * SMALLEST_THREE_RANGE);
+        normalized = std::clamp(normalized, 0.0f, 1.0f);
+        packed[n++] = static_cast<uint16_t>(
+            std::lround(normalized * SMALLEST_THREE_SCALE));
+    }
+
+    a = static_cast<uint16_t>(packed[0] | ((largest & 1u) << 15));
+    b = static_cast<uint16_t>(packed[1] | ((largest >> 1) << 15));
+    c = packed[2];
+}
+
+void assemble_rotation(uint16_t a, uint16_t b, float va, float vb, float vc,
+                       float* out) {
+    float w = std::sqrt(std::max(1.0f - va * va - vb * vb - vc * vc, 0.0f));
+    switch ((a >> 15) | ((b >> 15) << 1)) {
+        case 0:
+            out[0] = w, out[1] = va, out[2] = vb, out[3] = vc;
+            break;
+        case 1:
+            out[0] = va, out[1] = w, out[2] = vb, out[3] = vc;
+            break;
+        case 2:
+            out[0] = va, out[1] = vb, out[2] = w, out[3] = vc;
+            break;
+        default:
+            out[0] = va, out[1] = vb, out[2] = vc, out[3] = w;
+            break;
+    }
+}
+
+float decode_smallest(uint16_t value) {
+    return static_cast<float>(value & 0x7FFFu) *
+               (2.0f * SMALLEST_THREE_RANGE / SMALLEST_THREE_SCALE) -
+           SMALLEST_THREE_RANGE;
+}
+
+void decompress_scalars(const uint16_t* frame0, const uint16_t* frame1,
+                        const uint32_t* dests, const float* mins,
+                        const float* scales, uint32_t count, float alpha,
+                        float* pose) {
+#ifdef ANIM_COMPRESSED_CLIP_SSE2
+    alignas(16) float values[8];
+    __m128 t = _mm_set1_ps(alpha);
+    __m128i zero = _mm_setzero_si128();
+
+    for (uint32_t i = 0; i < count; i += 8) {
+        __m128i q0 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(frame0 + i));
+        __m128i q1 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(frame1 + i));
+
+        __m128 lo0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(q0, zero));
+        __m128 hi0 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(q0, zero));
+        __m128 lo1 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(q1, zero));
+        __m128 hi1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(q1, zero));
+
+        __m128 lo = _mm_add_ps(lo0, _mm_mul_ps(_mm_sub_ps(lo1, lo0), t));
+        __m128 hi = _mm_add_ps(hi0, _mm_mul_ps(_mm_sub_ps(hi1, hi0), t));
+
+        lo = _mm_add_ps(_mm_loadu_ps(mins + i),
+                        _mm_mul_ps(lo, _mm_loadu_ps(scales + i)));
+        hi = _mm_add_ps(_mm_loadu_ps(mins + i + 4),
+                        _mm_mul_ps(hi, _mm_loadu_ps(scales + i + 4)));
+
+        _mm_store_ps(values, lo);
+        _mm_store_ps(values + 4, hi);
+
+        uint32_t lanes = std::min(count - i, 8u);
+        for (uint32_t k = 0; k < lanes; ++k) {
+            pose[dests[i + k]] = values[k];
+        }
+    }
+#else
+    for (uint32_t i = 0; i < count; ++i) {
+        float q0 = static_cast<float>(frame0[i]);
+        float q1 = static_cast<float>(frame1[i]);
+        pose[dests[i]] = mins[i] + (q0 + (q1 - q0) * alpha) * scales[i];
+    }
+#endif
+}
+
+void decode_rotations(const uint16_t* a, const uint16_t* b, const uint16_t* c,
+                      uint32_t first, uint32_t lanes, float* x, float* y,
+                      float* z, float* w) {
+    for (uint32_t k = 0; k < lanes; ++k) {
+        uint32_t i = first + k;
+        float q[4];
+        assemble_rotation(a[i], b[i], decode_smallest(a[i]),
+                          decode_smallest(b[i]), decode_smallest(c[i]), q);
+        x[k] = q[0];
+        y[k] = q[1];
+        z[k] = q[2];
+        w[k] = q[3];
+    }
+}
+
+void decompress_rotations(const uint16_t* frame0, const uint16_t* frame1,
+                          uint32_t stride, const uint32_t* joints,
+                          uint32_t count, float alpha, float* pose) {
+    const uint16_t* a0 = frame0;
+    const uint16_t* b0 = frame0 + stride;
+    const uint16_t* c0 = frame0 + 2 * stride;
+    const uint16_t* a1 = frame1;
+    const uint16_t* b1 = frame1 + stride;
+    const uint16_t* c1 = frame1 + 2 * stride;
+
+    alignas(16) float x0[4] = {}, y0[4] = {}, z0[4] = {};
+    alignas(16) float x1[4] = {}, y1[4] = {}, z1[4] = {};
+    alignas(16) float w0[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    alignas(16) float w1[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    for (uint32_t i = 0; i < count; i += 4) {
+        uint32_t lanes = std::min(count - i, 4u);
+        decode_rotations(a0, b0, c0, i, lanes, x0, y0, z0, w0);
+        decode_rotations(a1, b1, c1, i, lanes, x1, y1, z1, w1);
+
+#ifdef ANIM_COMPRESSED_CLIP_SSE2
+        __m128 qx0 = _mm_load_ps(x0), qy0 = _mm_load_ps(y0);
+        __m128 qz0 = _mm_load_ps(z0), qw0 = _mm_load_ps(w0);
+        __m128 qx1 = _mm_load_ps(x1), qy1 = _mm_load_ps(y1);
+        __m128 qz1 = _mm_load_ps(z1), qw1 = _mm_load_ps(w1);
+
+        __m128 d = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(qx0, qx1), _mm_mul_ps(qy0, qy1)),
+            _mm_add_ps(_mm_mul_ps(qz0, qz1), _mm_mul_ps(qw0, qw1)));
+        __m128 flip = _mm_and_ps(_mm_cmplt_ps(d, _mm_setzero_ps()),
+                                 _mm_set1_ps(-0.0f));
+        qx1 = _mm_xor_ps(qx1, flip);
+        qy1 = _mm_xor_ps(qy1, flip);
+        qz1 = _mm_xor_ps(qz1, flip);
+        qw1 = _mm_xor_ps(qw1, flip);
+
+        __m128 t = _mm_set1_ps(alpha);
+        __m128 qx = _mm_add_ps(qx0, _mm_mul_ps(_mm_sub_ps(qx1, qx0), t));
+        __m128 qy = _mm_add_ps(qy0, _mm_mul_ps(_mm_sub_ps(qy1, qy0), t));
+        __m128 qz = _mm_add_ps(qz0, _mm_mul_ps(_mm_sub_ps(qz1, qz0), t));
+        __m128 qw = _mm_add_ps(qw0, _mm_mul_ps(_mm_sub_ps(qw1, qw0), t));
+
+        __m128 len_sq = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)),
+            _mm_add_ps(_mm_mul_ps(qz, qz), _mm_mul_ps(qw, qw)));
+        __m128 inv_len = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(len_sq));
+
+        _mm_store_ps(x0, _mm_mul_ps(qx, inv_len));
+        _mm_store_ps(y0, _mm_mul_ps(qy, inv_len));
+        _mm_store_ps(z0, _mm_mul_ps(qz, inv_len));
+        _mm_store_ps(w0, _mm_mul_ps(qw, inv_len));
+#else
+        for (uint32_t k = 0; k < lanes; ++k) {
+            Quat from(x0[k], y0[k], z0[k], w0[k]);
+            Quat to(x1[k], y1[k], z1[k], w1[k]);
+            if (dot(from, to) < 0.0f) {
+                to = -to;
+            }
+            Quat q = nlerp(from, to, alpha);
+            x0[k] = q.x;
+            y0[k] = q.y;
+            z0[k] = q.z;
+            w0[k] = q.w;
+        }
+#endif
+
+        for (uint32_t k = 0; k < lanes; ++k) {
+            float* dest = pose + joints[i + k] * TRANSFORM_FLOATS +
+                          ROTATION_OFFSET;
+            dest[0] = x0[k];
+            dest[1] = y0[k];
+            dest[2] = z0[k];
+            dest[3] = w0[k];
+        }
+    }
+}
+
+} // namespace
+
+CompressedClip::CompressedClip() : _header{nullptr} {}
+
+CompressedClip::CompressedClip(const CompressedClip& other)
+    : _header{nullptr} {
+    *this = other;
+}
+
+CompressedClip::CompressedClip(CompressedClip&& other) noexcept
+    : _header{nullptr} {
+    *this = std::move(other);
+}
+
+CompressedClip& CompressedClip::operator=(const CompressedClip& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    _name = other._name;
+    _storage = other._storage;
+    _header = _storage.empty() ? other._header
+                               : reinterpret_cast<const CompressedClipHeader*>(
+                                     _storage.data());
+    return *this;
+}
+
+CompressedClip& CompressedClip::operator=(CompressedClip&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    _name = std::move(other._name);
+    _storage = std::move(other._storage);
+    _header = other._header;
+    other._storage.clear();
+    other._header = nullptr;
+    return *this;
+}
+
+bool CompressedClip::compress(const Clip& clip, const Skeleton& skeleton,
+                              const CompressedClipSettings& settings) {
+    clear();
+
+    const Pose& rest = skeleton.rest_pose();
+    uint32_t num_joints = rest.size();
+    float duration = clip.duration();
+    if (num_joints == 0 || duration <= 0.0f || settings.sample_rate <= 0.0f) {
+        return false;
+    }
+
+    double intervals = std::ceil(static_cast<double>(duration) *
+                                 static_cast<double>(settings.sample_rate));
+    if (intervals >= static_cast<double>(UINT32_MAX)) {
+        return false;
+    }
+    uint32_t num_samples = static_cast<uint32_t>(intervals) + 1;
+    float sample_rate = static_cast<float>(num_samples - 1) / duration;
+
+    std::vector<ConstantScalar> constant_scalars;
+    std::vector<AnimatedScalar> animated_scalars;
+    std::vector<ConstantRotation> constant_rotations;
+    std::vector<uint32_t> animated_rotations;
+    std::vector<std::vector<Transform>> joint_samples;
+    std::vector<uint32_t> sample_index(num_joints, 0);
+
+    std::vector<Transform> samples(num_samples);
+    for (unsigned int t = 0; t < clip.size(); ++t) {
+        const TransformTrack& track = clip.track(t);
+        uint32_t joint = track.id();
+        if (joint >= num_joints) {
+            continue;
+        }
+
+        const Transform& ref = rest.local_transform(joint);
+        for (uint32_t s = 0; s < num_samples; ++s) {
+            float time = std::min(clip.start_time() +
+                                      static_cast<float>(s) / sample_rate,
+                                  clip.end_time());
+            samples[s] = track.sample(ref, time, false);
+        }
+
+        auto add_scalars = [&](uint32_t offset, const Vec3 Transform::*member,
+                               float tolerance) {
+            for (uint32_t c = 0; c < 3; ++c) {
+                float min = (samples[0].*member).v[c];
+                float max = min;
+                for (const Transform& sample : samples) {
+                    min = std::min(min, (sample.*member).v[c]);
+                    max = std::max(max, (sample.*member).v[c]);
+                }
+
+                uint32_t dest = joint * TRANSFORM_FLOATS + offset + c;
+                if (max - min <= tolerance) {
+                    float value = (min + max) * 0.5f;
+                    if (std::abs(value - (ref.*member).v[c]) > tolerance) {
+                        constant_scalars.push_back({dest, value});
+                    }
+                    continue;
+                }
+                animated_scalars.push_back({dest, min, max - min});
+            }
+        };
+        add_scalars(POSITION_OFFSET, &Transform::position,
+                    settings.position_tolerance);
+        add_scalars(SCALE_OFFSET, &Transform::scale, settings.scale_tolerance);
+
+        Quat first = normalized(samples[0].rotation);
+        bool constant = true;
+        for (const Transform& sample : samples) {
+            if (rotation_error(first, sample.rotation) >
+                settings.rotation_tolerance) {
+                constant = false;
+                break;
+            }
+        }
+        if (constant) {
+            if (rotation_error(first, ref.rotation) >
+                settings.rotation_tolerance) {
+                constant_rotations.push_back(
+                    {joint, {first.x, first.y, first.z, first.w}});
+            }
+        } else {
+            animated_rotations.push_back(joint);
+        }
+        sample_index[joint] = static_cast<uint32_t>(joint_samples.size());
+        joint_samples.push_back(samples);
+    }
+
+    uint32_t num_scalars = static_cast<uint32_t>(animated_scalars.size());
+    uint32_t num_rotations = static_cast<uint32_t>(animated_rotations.size());
+    uint32_t scalar_stride = align_up(num_scalars, 8);
+    uint32_t rotation_stride = align_up(num_rotations, 8);
+
+    CompressedClipHeader header{};
+    header.version = COMPRESSED_CLIP_VERSION;
+    header.num_joints = num_joints;
+    header.num_samples = num_samples;
+    header.sample_rate = sample_rate;
+    header.start_time = clip.start_time();
+    header.duration = duration;
+    header.looping = clip.looping() ? 1 : 0;
+    header.num_constant_scalars =
+        static_cast<uint32_t>(constant_scalars.size());
+    header.num_animated_scalars = num_scalars;
+    header.num_constant_rotations =
+        static_cast<uint32_t>(constant_rotations.size());
+    header.num_animated_rotations = num_rotations;
+
+    // 按 64 位计算布局，采样多或通道多时总大小可能超出 32 位的偏移。
+    uint64_t offset = align_up64(sizeof(CompressedClipHeader), 16);
+    uint64_t constant_scalar_offset = offset;
+    offset = align_up64(offset + uint64_t{header.num_constant_scalars} *
+                                     sizeof(ConstantScalar),
+                        16);
+    uint64_t animated_scalar_offset = offset;
+    offset = align_up64(offset + uint64_t{scalar_stride} * 3 *
+                                     sizeof(uint32_t),
+                        16);
+    uint64_t constant_rotation_offset = offset;
+    offset = align_up64(offset + uint64_t{header.num_constant_rotations} *
+                                     sizeof(ConstantRotation),
+                        16);
+    uint64_t animated_rotation_offset = offset;
+    offset = align_up64(offset + uint64_t{rotation_stride} * sizeof(uint32_t),
+                        16);
+    uint64_t frame_stride = align_up64(
+        (uint64_t{scalar_stride} + 3 * uint64_t{rotation_stride}) *
+            sizeof(uint16_t),
+        16);
+    uint64_t total_size = offset + frame_stride * num_samples;
+    if (total_size > UINT32_MAX) {
+        return false;
+    }
+
+    // 总大小不超过 32 位，其中的各个偏移也就不会超出。
+    header.constant_scalar_offset =
+        static_cast<uint32_t>(constant_scalar_offset);
+    header.animated_scalar_offset =
+        static_cast<uint32_t>(animated_scalar_offset);
+    header.constant_rotation_offset =
+        static_cast<uint32_t>(constant_rotation_offset);
+    header.animated_rotation_offset =
+        static_cast<uint32_t>(animated_rotation_offset);
+    header.samples_offset = static_cast<uint32_t>(offset);
+    header.frame_stride = static_cast<uint32_t>(frame_stride);
+    header.total_size = static_cast<uint32_t>(total_size);
+
+    _storage.assign((uint64_t{header.total_size} + 7) / 8, 0);
+    uint8_t* base = reinterpret_cast<uint8_t*>(_storage.data());
+    std::memcpy(base, &header, sizeof(header));
+
+    std::copy(constant_scalars.begin(), constant_scalars.end(),
+              at<ConstantScalar>(base, header.constant_scalar_offset));
+    std::copy(constant_rotations.begin(), constant_rotations.end(),
+              at<ConstantRotation>(base, header.constant_rotation_offset));
+    std::copy(animated_rotations.begin(), animated_rotations.end(),
+              at<uint32_t>(base, header.animated_rotation_offset));
+
+    uint32_t* dests = at<uint32_t>(base, header.animated_scalar_offset);
+    float* mins = reinterpret_cast<float*>(dests + scalar_stride);
+    float* scales = mins + scalar_stride;
+    for (uint32_t i = 0; i < num_scalars; ++i) {
+        dests[i] = animated_scalars[i].dest;
+        mins[i] = animated_scalars[i].min;
+        scales[i] = animated_scalars[i].extent / QUANTIZE_SCALE;
+    }
+
+    for (uint32_t s = 0; s < num_samples; ++s) {
+        uint16_t* frame = at<uint16_t>(
+            base, header.samples_offset + s * header.frame_stride);
+
+        for (uint32_t i = 0; i < num_scalars; ++i) {
+            const AnimatedScalar& scalar = animated_scalars[i];
+            uint32_t joint = scalar.dest / TRANSFORM_FLOATS;
+            const float* values = reinterpret_cast<const float*>(
+                &joint_samples[sample_index[joint]][s]);
+            frame[i] = quantize(values[scalar.dest % TRANSFORM_FLOATS],
+                                scalar.min, scalar.extent);
+        }
+
+        uint16_t* rotations = frame + scalar_stride;
+        for (uint32_t i = 0; i < num_rotations; ++i) {
+            uint32_t joint = animated_rotations[i];
+            const Transform& sample = joint_samples[sample_index[joint]][s];
+            encode_rotation(sample.rotation, rotations[i],
+                            rotations[rotation_stride + i],
+                            rotations[2 * rotation_stride + i]);
+        }
+    }
+
+    _header = reinterpret_cast<const CompressedClipHeader*>(base);
+    return true;
+}
+
+bool CompressedClip::attach(const void* data, size_t size) {
+    clear();
+
+    if (!data || size < sizeof(CompressedClipHeader) ||
+        reinterpret_cast<uintptr_t>(data) % alignof(CompressedClipHeader) !=
+            0) {
+        return false;
+    }
+
+    // 数据可能直接来自磁盘，所有偏移和写入位置都要检查。
+    const CompressedClipHeader* header =
+        static_cast<const CompressedClipHeader*>(data);
+    if (header->version != COMPRESSED_CLIP_VERSION ||
+        header->total_size > size || !validate(*header)) {
+        return false;
+    }
+
+    _header = header;
+    return true;
+}
+
+void CompressedClip::clear() {
+    _storage.clear();
+    _header = nullptr;
+}
+
+float CompressedClip::adjust_time_to_fit_range(float time) const {
+    float duration = this->duration();
+    if (duration <= 0.0f) {
+        return 0.0f;
+    }
+
+    float start = start_time();
+    if (looping()) {
+        time = std::fmod(time - start, duration);
+        if (time < 0.0f) {
+            time += duration;
+        }
+        return time + start;
+    }
+
+    return std::clamp(time, start, start + duration);
+}
+
+float CompressedClip::sample(Pose& out, float time) const {
+    if (!_header || out.size() < _header->num_joints) {
+        return 0.0f;
+    }
+
+    const CompressedClipHeader* header = _header;
+    time = adjust_time_to_fit_range(time);
+
+    float frame = (time - header->start_time) * header->sample_rate;
+    uint32_t last = header->num_samples - 2;
+    uint32_t index = std::min(
+        static_cast<uint32_t>(std::max(std::floor(frame), 0.0f)), last);
+    float alpha = std::clamp(frame - static_cast<float>(index), 0.0f, 1.0f);
+
+    float* pose = reinterpret_cast<float*>(out.data());
+
+    const ConstantScalar* constant_scalars =
+        at<ConstantScalar>(header, header->constant_scalar_offset);
+    for (uint32_t i = 0; i < header->num_constant_scalars; ++i) {
+        pose[constant_scalars[i].dest] = constant_scalars[i].value;
+    }
+
+    const ConstantRotation* constant_rotations =
+        at<ConstantRotation>(header, header->constant_rotation_offset);
+    for (uint32_t i = 0; i < header->num_constant_rotations; ++i) {
+        float* dest = pose + constant_rotations[i].joint * TRANSFORM_FLOATS +
+                      ROTATION_OFFSET;
+        std::memcpy(dest, constant_rotations[i].value, 4 * sizeof(float));
+    }
+
+    uint32_t scalar_stride = align_up(header->num_animated_scalars, 8);
+    uint32_t rotation_stride = align_up(header->num_animated_rotations, 8);
+    const uint16_t* frame0 = at<uint16_t>(
+        header, header->samples_offset + index * header->frame_stride);
+    const uint16_t* frame1 = at<uint16_t>(
+        header, header->samples_offset + (index + 1) * header->frame_stride);
+
+    const uint32_t* dests =
+        at<uint32_t>(header, header->animated_scalar_offset);
+    const float* mins = reinterpret_cast<const float*>(dests + scalar_stride);
+    const float* scales = mins + scalar_stride;
+    decompress_scalars(frame0, frame1, dests, mins, scales,
+                       header->num_animated_scalars, alpha, pose);
+
+    decompress_rotations(
+        frame0 + scalar_stride, frame1 + scalar_stride, rotation_stride,
+        at<uint32_t>(header, header->animated_rotation_offset),
+        header->num_animated_rotations, alpha, pose);
+
+    return time;
+}
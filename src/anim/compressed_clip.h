@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "clip.h"
+#include "pose.h"
+#include "skeleton.h"
+
+constexpr uint32_t COMPRESSED_CLIP_VERSION = 1;
+
+// 压缩数据是一整块不含指针的内存，所有数组都以相对块首的偏移描述，
+// 因此既可以由 compress() 生成，也可以直接指向映射进来的文件。
+struct CompressedClipHeader {
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t num_joints;
+    uint32_t num_samples;
+    float sample_rate;
+    float start_time;
+    float duration;
+    uint32_t looping;
+
+    uint32_t num_constant_scalars;
+    uint32_t num_animated_scalars;
+    uint32_t num_constant_rotations;
+    uint32_t num_animated_rotations;
+
+    uint32_t constant_scalar_offset;
+    uint32_t animated_scalar_offset;
+    uint32_t constant_rotation_offset;
+    uint32_t animated_rotation_offset;
+    uint32_t samples_offset;
+    uint32_t frame_stride;
+};
+
+struct CompressedClipSettings {
+    float sample_rate = 30.0f;
+    float position_tolerance = 1e-5f;
+    float rotation_tolerance = 1e-5f;
+    float scale_tolerance = 1e-5f;
+};
+
+class CompressedClip {
+public:
+    CompressedClip();
+    CompressedClip(const CompressedClip& other);
+    CompressedClip(CompressedClip&& other) noexcept;
+
+    CompressedClip& operator=(const CompressedClip& other);
+    CompressedClip& operator=(CompressedClip&& other) noexcept;
+
+    // 空动画、采样率无效或压缩结果超过 32 位偏移能表示的大小时返回 false。
+    bool compress(const Clip& clip, const Skeleton& skeleton,
+                  const CompressedClipSettings& settings);
+    bool attach(const void* data, size_t size);
+    void clear();
+
+    const std::string& name() const { return _name; }
+    void set_name(const std::string& name) { _name = name; }
+
+    bool empty() const { return _header == nullptr; }
+    const uint8_t* data() const {
+        return reinterpret_cast<const uint8_t*>(_header);
+    }
+    size_t size() const { return _header ? _header->total_size : 0; }
+
+    bool looping() const { return _header && _header->looping != 0; }
+    float start_time() const { return _header ? _header->start_time : 0.0f; }
+    float duration() const { return _header ? _header->duration : 0.0f; }
+    float end_time() const { return start_time() + duration(); }
+    unsigned int num_joints() const {
+        return _header ? _header->num_joints : 0;
+    }
+
+    // out 应当先以骨架的 rest pose 初始化，默认值轨道不会被写入。
+    float sample(Pose& out, float time) const;
+    float adjust_time_to_fit_range(float time) const;
+
+private:
+    std::string _name;
+    std::vector<uint64_t> _storage;
+    const CompressedClipHeader* _header;
+};
@@ -0,0 +1,58 @@
+#include "event_track.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+struct EventNames {
+    std::mutex mutex;
+    std::unordered_map<std::string, EventId> ids;
+    std::deque<std::string> names;
+};
+
+EventNames& event_names() {
+    static EventNames names;
+    return names;
+}
+
+} // namespace
+
+EventId intern_event(const std::string& name) {
+    EventNames& names = event_names();
+    std::lock_guard<std::mutex> lock(names.mutex);
+
+    auto it = names.ids.find(name);
+    if (it != names.ids.end()) {
+        return it->second;
+    }
+
+    EventId id = static_cast<EventId>(names.names.size());
+    names.names.push_back(name);
+    names.ids.emplace(name, id);
+    return id;
+}
+
+const std::string& event_name(EventId id) {
+    static const std::string unknown;
+    EventNames& names = event_names();
+    std::lock_guard<std::mutex> lock(names.mutex);
+
+    if (id >= names.names.size()) {
+        return unknown;
+    }
+    return names.names[id];
+}
+
+void EventTrack::add(float time, EventId id) {
+    auto it = std::upper_bound(_times.begin(), _times.end(), time);
+    size_t index = static_cast<size_t>(it - _times.begin());
+    _times.insert(it, time);
+    _ids.insert(_ids.begin() + static_cast<std::ptrdiff_t>(index), id);
+}
+
+void EventTrack::clear() {
+    _times.clear();
+    _ids.clear();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using EventId = uint32_t;
+
+EventId intern_event(const std::string& name);
+const std::string& event_name(EventId id);
+
+class EventTrack {
+public:
+    void add(float time, EventId id);
+    void clear();
+
+    unsigned int size() const {
+        return static_cast<unsigned int>(_times.size());
+    }
+    float time(unsigned int index) const { return _times[index]; }
+    EventId id(unsigned int index) const { return _ids[index]; }
+
+    // 以 time 为起点推进 dt，按经过的先后顺序回调 fn(id, time)。
+    // 正向播放区间为 [from, to)，反向为 (to, from]，循环时按圈展开。
+    template <typename F>
+    void query(float time, float dt, float start, float end, bool looping,
+               F&& fn) const;
+
+private:
+    template <typename F>
+    void visit(float lo, float hi, bool reverse, bool inclusive,
+               float offset, F& fn) const;
+
+    std::vector<float> _times;
+    std::vector<EventId> _ids;
+};
+
+template <typename F>
+void EventTrack::query(float time, float dt, float start, float end,
+                       bool looping, F&& fn) const {
+    if (_times.empty() || dt == 0.0f) {
+        return;
+    }
+
+    float duration = end - start;
+    bool reverse = dt < 0.0f;
+    if (!looping || duration <= 0.0f) {
+        float from = std::clamp(time, start, end);
+        float to = std::clamp(time + dt, start, end);
+        if (from == to) {
+            return;
+        }
+
+        bool inclusive = reverse ? to <= start : to >= end;
+        visit(reverse ? to : from, reverse ? from : to, reverse, inclusive,
+              0.0f, fn);
+        return;
+    }
+
+    float lo = reverse ? time + dt : time;
+    float hi = reverse ? time : time + dt;
+    int first_loop = static_cast<int>(std::floor((lo - start) / duration));
+    int last_loop = static_cast<int>(std::floor((hi - start) / duration));
+
+    if (reverse) {
+        for (int loop = last_loop; loop >= first_loop; --loop) {
+            float offset = static_cast<float>(loop) * duration;
+            visit(lo - offset, hi - offset, true, false, offset, fn);
+        }
+    } else {
+        for (int loop = first_loop; loop <= last_loop; ++loop) {
+            float offset = static_cast<float>(loop) * duration;
+            visit(lo - offset, hi - offset, false, false, offset, fn);
+        }
+    }
+}
+
+template <typename F>
+void EventTrack::visit(float lo, float hi, bool reverse, bool inclusive,
+                       float offset, F& fn) const {
+    auto times_begin = _times.begin();
+    if (!reverse) {
+        auto first = std::lower_bound(times_begin, _times.end(), lo);
+        auto last = inclusive ? std::upper_bound(first, _times.end(), hi)
+                              : std::lower_bound(first, _times.end(), hi);
+        for (auto it = first; it != last; ++it) {
+            size_t index = static_cast<size_t>(it - times_begin);
+            fn(_ids[index], *it + offset);
+        }
+        return;
+    }
+
+    auto first = inclusive ? std::lower_bound(times_begin, _times.end(), lo)
+                           : std::upper_bound(times_begin, _times.end(), lo);
+    auto last = std::upper_bound(first, _times.end(), hi);
+    for (auto it = last; it != first; --it) {
+        size_t index = static_cast<size_t>(it - times_begin) - 1;
+        fn(_ids[index], _times[index] + offset);
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+template <unsigned int N>
+struct Frame {
+    float value[N];
+    float in[N];
+    float out[N];
+    float time;
+};
+
+using ScalarFrame = Frame<1>;
+using VectorFrame = Frame<3>;
+using QuaternionFrame = Frame<4>;
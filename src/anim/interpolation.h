@@ -0,0 +1,7 @@
+#pragma once
+
+enum class Interpolation {
+    Constant,
+    Linear,
+    Cubic,
+};
@@ -0,0 +1,112 @@
+#include "lod.h"
+
+#include <algorithm>
+
+#include "../math/transform.h"
+
+LodSettings::LodSettings(const Skeleton& skeleton,
+                         const std::vector<LodLevel>& levels) {
+    build(skeleton, levels);
+}
+
+void LodSettings::build(const Skeleton& skeleton,
+                        const std::vector<LodLevel>& levels) {
+    _levels = levels;
+    std::sort(_levels.begin(), _levels.end(),
+              [](const LodLevel& lhs, const LodLevel& rhs) {
+                  return lhs.max_metric < rhs.max_metric;
+              });
+
+    const Pose& rest = skeleton.rest_pose();
+    unsigned int num_joints = rest.size();
+    std::vector<unsigned int> depths(num_joints, 0);
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        unsigned int depth = 0;
+        for (int p = rest.parent(i); p >= 0; p = rest.parent(p)) {
+            ++depth;
+        }
+        depths[i] = depth;
+    }
+
+    _masks.resize(_levels.size());
+    for (size_t l = 0; l < _levels.size(); ++l) {
+        JointMask& mask = _masks[l];
+        mask.resize(num_joints);
+        for (unsigned int i = 0; i < num_joints; ++i) {
+            mask[i] = depths[i] <= _levels[l].max_joint_depth ? 1 : 0;
+        }
+
+        _levels[l].update_interval =
+            std::max(_levels[l].update_interval, 1u);
+    }
+}
+
+unsigned int LodSettings::select(float metric) const {
+    for (unsigned int i = 0; i < size(); ++i) {
+        if (metric <= _levels[i].max_metric) {
+            return i;
+        }
+    }
+    return size() > 0 ? size() - 1 : 0;
+}
+
+LodCharacter::LodCharacter()
+    : _phase{0}, _level{0}, _frames_since_sample{0}, _pending_dt{0.0f},
+      _sampled{false}, _has_sample{false} {}
+
+void LodCharacter::init(const Skeleton& skeleton, unsigned int phase) {
+    _pose = skeleton.rest_pose();
+    _prev_pose = _pose;
+    _next_pose = _pose;
+    _phase = phase;
+    _level = 0;
+    _frames_since_sample = 0;
+    _pending_dt = 0.0f;
+    _sampled = false;
+    _has_sample = false;
+}
+
+void LodCharacter::update(const LodSettings& settings, ClipPlayer& player,
+                          float metric, float dt, uint64_t frame) {
+    _sampled = false;
+    _pending_dt += dt;
+    if (settings.size() == 0) {
+        return;
+    }
+
+    unsigned int level = settings.select(metric);
+    unsigned int interval = settings.level(level).update_interval;
+    bool finer = level < _level;
+    _level = level;
+
+    bool due = (frame + _phase) % interval == 0;
+    if (!_has_sample || finer || due) {
+        const JointMask& mask = settings.joint_mask(level);
+
+        _prev_pose = _next_pose;
+        player.update(_next_pose, _pending_dt, &mask);
+
+        _pending_dt = 0.0f;
+        _frames_since_sample = 0;
+        _sampled = true;
+        if (!_has_sample || interval == 1) {
+            _prev_pose = _next_pose;
+            _has_sample = true;
+        }
+    } else {
+        ++_frames_since_sample;
+    }
+
+    if (interval == 1) {
+        _pose = _next_pose;
+        return;
+    }
+
+    float t = static_cast<float>(_frames_since_sample) /
+              static_cast<float>(interval);
+    t = std::min(t, 1.0f);
+    for (unsigned int i = 0; i < _pose.size(); ++i) {
+        _pose.set_local_transform(i, mix(_prev_pose.local_transform(i),
+                                         _next_pose.local_transform(i), t));
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "clip.h"
+#include "clip_player.h"
+#include "pose.h"
+#include "skeleton.h"
+
+struct LodLevel {
+    float max_metric;
+    unsigned int update_interval;
+    unsigned int max_joint_depth;
+};
+
+// 每个骨架预先计算好各级 LOD 的关节子集，运行时只需按度量值查表。
+// 度量值可以是到相机的距离，也可以是屏幕占比的倒数，只要越大越粗糙即可。
+class LodSettings {
+public:
+    LodSettings() = default;
+    LodSettings(const Skeleton& skeleton, const std::vector<LodLevel>& levels);
+
+    void build(const Skeleton& skeleton, const std::vector<LodLevel>& levels);
+
+    unsigned int size() const {
+        return static_cast<unsigned int>(_levels.size());
+    }
+    const LodLevel& level(unsigned int index) const { return _levels[index]; }
+    const JointMask& joint_mask(unsigned int index) const {
+        return _masks[index];
+    }
+
+    unsigned int select(float metric) const;
+
+private:
+    std::vector<LodLevel> _levels;
+    std::vector<JointMask> _masks;
+};
+
+class LodCharacter {
+public:
+    LodCharacter();
+
+    void init(const Skeleton& skeleton, unsigned int phase);
+
+    void update(const LodSettings& settings, ClipPlayer& player, float metric,
+                float dt, uint64_t frame);
+
+    const Pose& pose() const { return _pose; }
+    unsigned int level() const { return _level; }
+    bool sampled() const { return _sampled; }
+
+private:
+    Pose _pose;
+    Pose _prev_pose;
+    Pose _next_pose;
+    unsigned int _phase;
+    unsigned int _level;
+    unsigned int _frames_since_sample;
+    float _pending_dt;
+    bool _sampled;
+    bool _has_sample;
+};
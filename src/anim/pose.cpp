@@ -0,0 +1,56 @@
+#include "pose.h"
+
+void Pose::resize(unsigned int size) {
+    _joints.resize(size);
+    _parents.resize(size, -1);
+}
+
+Transform Pose::global_transform(unsigned int index) const {
+    Transform result = _joints[index];
+    for (int p = _parents[index]; p >= 0; p = _parents[p]) {
+        result = combine(_joints[p], result);
+    }
+    return result;
+}
+
+void Pose::get_matrix_palette(std::vector<Mat4>& out) const {
+    unsigned int size = this->size();
+    if (out.size() != size) {
+        out.resize(size);
+    }
+
+    unsigned int i = 0;
+    for (; i < size; ++i) {
+        int p = _parents[i];
+        if (p >= static_cast<int>(i)) {
+            break;
+        }
+
+        Mat4 global = transform_to_mat(_joints[i]);
+        if (p >= 0) {
+            global = out[p] * global;
+        }
+        out[i] = global;
+    }
+
+    for (; i < size; ++i) {
+        out[i] = transform_to_mat(global_transform(i));
+    }
+}
+
+bool Pose::operator==(const Pose& other) const {
+    if (_joints.size() != other._joints.size()) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < size(); ++i) {
+        const Transform& lhs = _joints[i];
+        const Transform& rhs = other._joints[i];
+        if (_parents[i] != other._parents[i] ||
+            lhs.position != rhs.position || lhs.rotation != rhs.rotation ||
+            lhs.scale != rhs.scale) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "../math/mat4.h"
+#include "../math/transform.h"
+
+class Pose {
+public:
+    Pose() = default;
+    explicit Pose(unsigned int num_joints) { resize(num_joints); }
+
+    void resize(unsigned int size);
+    unsigned int size() const {
+        return static_cast<unsigned int>(_joints.size());
+    }
+
+    int parent(unsigned int index) const { return _parents[index]; }
+    void set_parent(unsigned int index, int parent) {
+        _parents[index] = parent;
+    }
+
+    const Transform& local_transform(unsigned int index) const {
+        return _joints[index];
+    }
+    void set_local_transform(unsigned int index, const Transform& transform) {
+        _joints[index] = transform;
+    }
+
+    Transform global_transform(unsigned int index) const;
+    void get_matrix_palette(std::vector<Mat4>& out) const;
+
+    Transform* data() { return _joints.data(); }
+    const Transform* data() const { return _joints.data(); }
+
+    bool operator==(const Pose& other) const;
+    bool operator!=(const Pose& other) const { return !(*this == other); }
+
+private:
+    std::vector<Transform> _joints;
+    std::vector<int> _parents;
+};
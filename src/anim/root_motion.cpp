@@ -0,0 +1,151 @@
+#include "root_motion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+RootMotionDelta ground_frame(const Transform& root) {
+    Quat yaw(0.0f, root.rotation.y, 0.0f, root.rotation.w);
+    if (len_sq(yaw) < QUAT_EPSILON) {
+        yaw = Quat();
+    }
+    return RootMotionDelta(Vec3(root.position.x, 0.0f, root.position.z),
+                           normalized(yaw));
+}
+
+} // namespace
+
+RootMotion::RootMotion()
+    : _start_time{0.0f}, _duration{0.0f}, _sample_rate{0.0f},
+      _looping{false} {}
+
+void RootMotion::bake(Clip& clip, unsigned int root_joint, float sample_rate) {
+    clear();
+
+    const TransformTrack* found = clip.find_track(root_joint);
+    float duration = clip.duration();
+    if (!found || duration <= 0.0f || sample_rate <= 0.0f) {
+        return;
+    }
+
+    TransformTrack original = *found;
+    _start_time = clip.start_time();
+    _duration = duration;
+    _looping = clip.looping();
+
+    unsigned int num_samples =
+        static_cast<unsigned int>(std::ceil(duration * sample_rate)) + 1;
+    num_samples = std::max(num_samples, 2u);
+    _sample_rate = static_cast<float>(num_samples - 1) / duration;
+
+    RootMotionDelta inv_start = inverse(
+        ground_frame(original.sample(Transform(), _start_time, false)));
+    auto cumulative = [&](float time) {
+        Transform root = original.sample(Transform(), time, false);
+        return combine(ground_frame(root), inv_start);
+    };
+
+    _positions.resize(num_samples);
+    _rotations.resize(num_samples);
+    for (unsigned int i = 0; i < num_samples; ++i) {
+        float time = _start_time + static_cast<float>(i) / _sample_rate;
+        RootMotionDelta motion = cumulative(std::min(time, clip.end_time()));
+        _positions[i] = motion.translation;
+        _rotations[i] = motion.rotation;
+    }
+
+    TransformTrack& root = clip[root_joint];
+
+    VectorTrack& position = root.position();
+    for (unsigned int i = 0; i < position.size(); ++i) {
+        VectorFrame& frame = position[i];
+        RootMotionDelta inv = inverse(cumulative(frame.time));
+
+        Vec3 value = inv.translation + inv.rotation * Vec3(frame.value);
+        Vec3 in = inv.rotation * Vec3(frame.in);
+        Vec3 out = inv.rotation * Vec3(frame.out);
+        for (int c = 0; c < 3; ++c) {
+            frame.value[c] = value.v[c];
+            frame.in[c] = in.v[c];
+            frame.out[c] = out.v[c];
+        }
+    }
+
+    QuaternionTrack& rotation = root.rotation();
+    for (unsigned int i = 0; i < rotation.size(); ++i) {
+        QuaternionFrame& frame = rotation[i];
+        RootMotionDelta inv = inverse(cumulative(frame.time));
+
+        Quat value = Quat(frame.value[0], frame.value[1], frame.value[2],
+                          frame.value[3]) *
+                     inv.rotation;
+        Quat in = Quat(frame.in[0], frame.in[1], frame.in[2], frame.in[3]) *
+                  inv.rotation;
+        Quat out = Quat(frame.out[0], frame.out[1], frame.out[2],
+                        frame.out[3]) *
+                   inv.rotation;
+        for (int c = 0; c < 4; ++c) {
+            frame.value[c] = value.v[c];
+            frame.in[c] = in.v[c];
+            frame.out[c] = out.v[c];
+        }
+    }
+}
+
+void RootMotion::clear() {
+    _start_time = 0.0f;
+    _duration = 0.0f;
+    _sample_rate = 0.0f;
+    _looping = false;
+    _positions.clear();
+    _rotations.clear();
+}
+
+RootMotionDelta RootMotion::delta(float time, float dt) const {
+    if (empty()) {
+        return RootMotionDelta();
+    }
+
+    float end_time = _start_time + _duration;
+    if (!_looping) {
+        float from = std::clamp(time, _start_time, end_time);
+        float to = std::clamp(time + dt, _start_time, end_time);
+        return combine(inverse(sample(from)), sample(to));
+    }
+
+    float from_loop = std::floor((time - _start_time) / _duration);
+    float to_loop = std::floor((time + dt - _start_time) / _duration);
+    float from = time - from_loop * _duration;
+    float to = time + dt - to_loop * _duration;
+
+    RootMotionDelta result = inverse(sample(from));
+    int loops = static_cast<int>(to_loop - from_loop);
+    if (loops != 0) {
+        RootMotionDelta loop(_positions.back(), _rotations.back());
+        if (loops < 0) {
+            loop = inverse(loop);
+            loops = -loops;
+        }
+        for (int i = 0; i < loops; ++i) {
+            result = combine(result, loop);
+        }
+    }
+    return combine(result, sample(to));
+}
+
+RootMotionDelta RootMotion::sample(float time) const {
+    float frame = (time - _start_time) * _sample_rate;
+    int last = static_cast<int>(_positions.size()) - 2;
+    int index = std::clamp(static_cast<int>(std::floor(frame)), 0, last);
+    float t = std::clamp(frame - static_cast<float>(index), 0.0f, 1.0f);
+
+    Quat from = _rotations[index];
+    Quat to = _rotations[index + 1];
+    if (dot(from, to) < 0.0f) {
+        to = -to;
+    }
+
+    return RootMotionDelta(lerp(_positions[index], _positions[index + 1], t),
+                           nlerp(from, to, t));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include "../math/quat.h"
+#include "../math/transform.h"
+#include "../math/vec3.h"
+#include "clip.h"
+
+struct RootMotionDelta {
+    Vec3 translation;
+    Quat rotation;
+
+    RootMotionDelta() = default;
+    RootMotionDelta(const Vec3& translation, const Quat& rotation)
+        : translation{translation}, rotation{rotation} {}
+};
+
+inline RootMotionDelta combine(const RootMotionDelta& d1,
+                               const RootMotionDelta& d2) {
+    return RootMotionDelta(d1.translation + d1.rotation * d2.translation,
+                           d2.rotation * d1.rotation);
+}
+
+inline RootMotionDelta inverse(const RootMotionDelta& d) {
+    Quat inv_rotation = conjugate(d.rotation);
+    return RootMotionDelta(-(inv_rotation * d.translation), inv_rotation);
+}
+
+inline Transform apply_root_motion(const Transform& t,
+                                   const RootMotionDelta& d) {
+    Transform result = t;
+    result.position = t.position + t.rotation * (t.scale * d.translation);
+    result.rotation = normalized(d.rotation * t.rotation);
+    return result;
+}
+
+// 导入时把根骨骼在地面上的位移和绕 Y 轴的旋转从 clip 中剥离出来，
+// 存成按固定采样率烘焙的累积轨道，运行时只需查表即可得到任意两个时刻间的增量。
+class RootMotion {
+public:
+    RootMotion();
+
+    void bake(Clip& clip, unsigned int root_joint, float sample_rate = 30.0f);
+    void clear();
+
+    bool empty() const { return _positions.empty(); }
+
+    RootMotionDelta delta(float time, float dt) const;
+
+private:
+    RootMotionDelta sample(float time) const;
+
+    float _start_time;
+    float _duration;
+    float _sample_rate;
+    bool _looping;
+    std::vector<Vec3> _positions;
+    std::vector<Quat> _rotations;
+};
@@ -0,0 +1,26 @@
+#include "skeleton.h"
+
+#include "../math/transform.h"
+
+Skeleton::Skeleton(const Pose& rest, const Pose& bind,
+                   const std::vector<std::string>& names) {
+    set(rest, bind, names);
+}
+
+void Skeleton::set(const Pose& rest, const Pose& bind,
+                   const std::vector<std::string>& names) {
+    _rest_pose = rest;
+    _bind_pose = bind;
+    _names = names;
+    update_inverse_bind_pose();
+}
+
+void Skeleton::update_inverse_bind_pose() {
+    unsigned int size = _bind_pose.size();
+    _inverse_bind_pose.resize(size);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        Transform world = _bind_pose.global_transform(i);
+        _inverse_bind_pose[i] = inverse(transform_to_mat(world));
+    }
+}
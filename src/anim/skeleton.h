@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../math/mat4.h"
+#include "pose.h"
+
+class Skeleton {
+public:
+    Skeleton() = default;
+    Skeleton(const Pose& rest, const Pose& bind,
+             const std::vector<std::string>& names);
+
+    void set(const Pose& rest, const Pose& bind,
+             const std::vector<std::string>& names);
+
+    unsigned int size() const { return _rest_pose.size(); }
+
+    const Pose& rest_pose() const { return _rest_pose; }
+    const Pose& bind_pose() const { return _bind_pose; }
+    const std::vector<Mat4>& inverse_bind_pose() const {
+        return _inverse_bind_pose;
+    }
+    const std::vector<std::string>& joint_names() const { return _names; }
+    const std::string& joint_name(unsigned int index) const {
+        return _names[index];
+    }
+
+private:
+    void update_inverse_bind_pose();
+
+    Pose _rest_pose;
+    Pose _bind_pose;
+    std::vector<Mat4> _inverse_bind_pose;
+    std::vector<std::string> _names;
+};
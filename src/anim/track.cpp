@@ -0,0 +1,222 @@
+#include "track.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+template <typename T>
+T to_value(const float* v);
+
+template <>
+float to_value<float>(const float* v) {
+    return v[0];
+}
+
+template <>
+Vec3 to_value<Vec3>(const float* v) {
+    return Vec3(v[0], v[1], v[2]);
+}
+
+template <>
+Quat to_value<Quat>(const float* v) {
+    return normalized(Quat(v[0], v[1], v[2], v[3]));
+}
+
+template <typename T>
+T to_tangent(const float* v) {
+    return to_value<T>(v);
+}
+
+template <>
+Quat to_tangent<Quat>(const float* v) {
+    return Quat(v[0], v[1], v[2], v[3]);
+}
+
+float interpolate(float a, float b, float t) { return a + (b - a) * t; }
+
+Vec3 interpolate(const Vec3& a, const Vec3& b, float t) {
+    return lerp(a, b, t);
+}
+
+Quat interpolate(const Quat& a, const Quat& b, float t) {
+    if (dot(a, b) < 0.0f) {
+        return nlerp(a, -b, t);
+    }
+    return nlerp(a, b, t);
+}
+
+void neighborhood(const float&, float&) {}
+void neighborhood(const Vec3&, Vec3&) {}
+void neighborhood(const Quat& a, Quat& b) {
+    if (dot(a, b) < 0.0f) {
+        b = -b;
+    }
+}
+
+float adjust_hermite_result(float v) { return v; }
+Vec3 adjust_hermite_result(const Vec3& v) { return v; }
+Quat adjust_hermite_result(const Quat& q) { return normalized(q); }
+
+template <typename T>
+T hermite(float t, const T& p1, const T& s1, const T& p2, const T& s2) {
+    float tt = t * t;
+    float ttt = tt * t;
+
+    T p2_n = p2;
+    neighborhood(p1, p2_n);
+
+    float h1 = 2.0f * ttt - 3.0f * tt + 1.0f;
+    float h2 = -2.0f * ttt + 3.0f * tt;
+    float h3 = ttt - 2.0f * tt + t;
+    float h4 = ttt - tt;
+
+    T result = p1 * h1 + p2_n * h2 + s1 * h3 + s2 * h4;
+    return adjust_hermite_result(result);
+}
+
+} // namespace
+
+template <typename T, unsigned int N>
+float Track<T, N>::start_time() const {
+    if (_frames.empty()) {
+        return 0.0f;
+    }
+    return _frames.front().time;
+}
+
+template <typename T, unsigned int N>
+float Track<T, N>::end_time() const {
+    if (_frames.empty()) {
+        return 0.0f;
+    }
+    return _frames.back().time;
+}
+
+template <typename T, unsigned int N>
+T Track<T, N>::sample(float time, bool looping) const {
+    if (_frames.empty()) {
+        return T();
+    }
+    if (_frames.size() == 1) {
+        return to_value<T>(_frames[0].value);
+    }
+
+    switch (_interpolation) {
+        case Interpolation::Constant:
+            return sample_constant(time, looping);
+        case Interpolation::Linear:
+            return sample_linear(time, looping);
+        case Interpolation::Cubic:
+            return sample_cubic(time, looping);
+    }
+    return T();
+}
+
+template <typename T, unsigned int N>
+T Track<T, N>::sample_constant(float time, bool looping) const {
+    float track_time = adjust_time_to_fit_track(time, looping);
+    if (track_time >= _frames.back().time) {
+        return to_value<T>(_frames.back().value);
+    }
+
+    int index = frame_index(time, looping);
+    if (index < 0) {
+        return T();
+    }
+    return to_value<T>(_frames[index].value);
+}
+
+template <typename T, unsigned int N>
+T Track<T, N>::sample_linear(float time, bool looping) const {
+    int index = frame_index(time, looping);
+    if (index < 0) {
+        return T();
+    }
+
+    const Frame<N>& this_frame = _frames[index];
+    const Frame<N>& next_frame = _frames[index + 1];
+
+    float frame_delta = next_frame.time - this_frame.time;
+    if (frame_delta <= 0.0f) {
+        return to_value<T>(this_frame.value);
+    }
+
+    float track_time = adjust_time_to_fit_track(time, looping);
+    float t = (track_time - this_frame.time) / frame_delta;
+    t = std::clamp(t, 0.0f, 1.0f);
+
+    return interpolate(to_value<T>(this_frame.value),
+                       to_value<T>(next_frame.value), t);
+}
+
+template <typename T, unsigned int N>
+T Track<T, N>::sample_cubic(float time, bool looping) const {
+    int index = frame_index(time, looping);
+    if (index < 0) {
+        return T();
+    }
+
+    const Frame<N>& this_frame = _frames[index];
+    const Frame<N>& next_frame = _frames[index + 1];
+
+    float frame_delta = next_frame.time - this_frame.time;
+    if (frame_delta <= 0.0f) {
+        return to_value<T>(this_frame.value);
+    }
+
+    float track_time = adjust_time_to_fit_track(time, looping);
+    float t = (track_time - this_frame.time) / frame_delta;
+    t = std::clamp(t, 0.0f, 1.0f);
+
+    T p1 = to_value<T>(this_frame.value);
+    T s1 = to_tangent<T>(this_frame.out) * frame_delta;
+    T p2 = to_value<T>(next_frame.value);
+    T s2 = to_tangent<T>(next_frame.in) * frame_delta;
+
+    return hermite(t, p1, s1, p2, s2);
+}
+
+template <typename T, unsigned int N>
+int Track<T, N>::frame_index(float time, bool looping) const {
+    unsigned int size = this->size();
+    if (size <= 1) {
+        return -1;
+    }
+
+    float track_time = adjust_time_to_fit_track(time, looping);
+    auto it = std::upper_bound(
+        _frames.begin(), _frames.end(), track_time,
+        [](float t, const Frame<N>& frame) { return t < frame.time; });
+
+    int index = static_cast<int>(it - _frames.begin()) - 1;
+    return std::clamp(index, 0, static_cast<int>(size) - 2);
+}
+
+template <typename T, unsigned int N>
+float Track<T, N>::adjust_time_to_fit_track(float time, bool looping) const {
+    if (_frames.size() <= 1) {
+        return 0.0f;
+    }
+
+    float start = _frames.front().time;
+    float end = _frames.back().time;
+    float duration = end - start;
+    if (duration <= 0.0f) {
+        return 0.0f;
+    }
+
+    if (looping) {
+        time = std::fmod(time - start, duration);
+        if (time < 0.0f) {
+            time += duration;
+        }
+        return time + start;
+    }
+
+    return std::clamp(time, start, end);
+}
+
+template class Track<float, 1>;
+template class Track<Vec3, 3>;
+template class Track<Quat, 4>;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include "../math/quat.h"
+#include "../math/vec3.h"
+#include "frame.h"
+#include "interpolation.h"
+
+template <typename T, unsigned int N>
+class Track {
+public:
+    Track() : _interpolation{Interpolation::Linear} {}
+
+    void resize(unsigned int size) { _frames.resize(size); }
+    unsigned int size() const {
+        return static_cast<unsigned int>(_frames.size());
+    }
+
+    Interpolation interpolation() const { return _interpolation; }
+    void set_interpolation(Interpolation interpolation) {
+        _interpolation = interpolation;
+    }
+
+    float start_time() const;
+    float end_time() const;
+
+    T sample(float time, bool looping) const;
+
+    Frame<N>& operator[](unsigned int index) { return _frames[index]; }
+    const Frame<N>& operator[](unsigned int index) const {
+        return _frames[index];
+    }
+
+private:
+    T sample_constant(float time, bool looping) const;
+    T sample_linear(float time, bool looping) const;
+    T sample_cubic(float time, bool looping) const;
+
+    int frame_index(float time, bool looping) const;
+    float adjust_time_to_fit_track(float time, bool looping) const;
+
+    std::vector<Frame<N>> _frames;
+    Interpolation _interpolation;
+};
+
+using ScalarTrack = Track<float, 1>;
+using VectorTrack = Track<Vec3, 3>;
+using QuaternionTrack = Track<Quat, 4>;
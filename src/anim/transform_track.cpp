@@ -0,0 +1,64 @@
+#include "transform_track.h"
+
+#include <algorithm>
+
+float TransformTrack::start_time() const {
+    float result = 0.0f;
+    bool is_set = false;
+
+    if (_position.size() > 1) {
+        result = _position.start_time();
+        is_set = true;
+    }
+    if (_rotation.size() > 1) {
+        float start = _rotation.start_time();
+        result = is_set ? std::min(result, start) : start;
+        is_set = true;
+    }
+    if (_scale.size() > 1) {
+        float start = _scale.start_time();
+        result = is_set ? std::min(result, start) : start;
+    }
+
+    return result;
+}
+
+float TransformTrack::end_time() const {
+    float result = 0.0f;
+    bool is_set = false;
+
+    if (_position.size() > 1) {
+        result = _position.end_time();
+        is_set = true;
+    }
+    if (_rotation.size() > 1) {
+        float end = _rotation.end_time();
+        result = is_set ? std::max(result, end) : end;
+        is_set = true;
+    }
+    if (_scale.size() > 1) {
+        float end = _scale.end_time();
+        result = is_set ? std::max(result, end) : end;
+    }
+
+    return result;
+}
+
+bool TransformTrack::is_valid() const {
+    return _position.size() > 0 || _rotation.size() > 0 || _scale.size() > 0;
+}
+
+Transform TransformTrack::sample(const Transform& ref, float time,
+                                 bool looping) const {
+    Transform result = ref;
+    if (_position.size() > 0) {
+        result.position = _position.sample(time, looping);
+    }
+    if (_rotation.size() > 0) {
+        result.rotation = _rotation.sample(time, looping);
+    }
+    if (_scale.size() > 0) {
+        result.scale = _scale.sample(time, looping);
+    }
+    return result;
+}
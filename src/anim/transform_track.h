@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../math/transform.h"
+#include "track.h"
+
+class TransformTrack {
+public:
+    TransformTrack() : _id{0} {}
+
+    unsigned int id() const { return _id; }
+    void set_id(unsigned int id) { _id = id; }
+
+    VectorTrack& position() { return _position; }
+    QuaternionTrack& rotation() { return _rotation; }
+    VectorTrack& scale() { return _scale; }
+    const VectorTrack& position() const { return _position; }
+    const QuaternionTrack& rotation() const { return _rotation; }
+    const VectorTrack& scale() const { return _scale; }
+
+    float start_time() const;
+    float end_time() const;
+    bool is_valid() const;
+
+    Transform sample(const Transform& ref, float time, bool looping) const;
+
+private:
+    unsigned int _id;
+    VectorTrack _position;
+    QuaternionTrack _rotation;
+    VectorTrack _scale;
+};
@@ -1,12 +1,33 @@
 #include "app.h"
 
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+
 #include <SDL3/SDL.h>
 #include <spdlog/spdlog.h>
 
+#include "../core/log.h"
 #include "../glad/glad.h"
 
-App::App()
-    : _is_running{false}, _window{nullptr}, _gl_context{nullptr},
+namespace {
+
+volatile std::sig_atomic_t g_stop_requested = 0;
+
+void request_stop(int) { g_stop_requested = 1; }
+
+// 前几帧容器还在增长，之后才开始检查分配。
+constexpr uint64_t ALLOC_WARMUP_FRAMES = 8;
+
+} // namespace
+
+App::App() : App(AppConfig{}) {}
+
+App::App(const AppConfig& config)
+    : _config{config}, _accumulator{0.0f}, _worst_frame_allocs{0},
+      _sim_frame{0}, _sim_frame_time{0.0f}, _sim_busy{false},
+      _sim_stop{false}, _is_running{false}, _window{nullptr},
+      _gl_context{nullptr}, _job_system{nullptr}, _asset_loader{nullptr},
       _scene_handler{nullptr} {}
 
 App::~App() {
@@ -23,10 +44,52 @@ void App::run(SceneBase* start_scene) {
 
     _scene_handler->switch_scene(start_scene);
 
+    _clock.reset();
+    _limiter.reset();
+    _accumulator = 0.0f;
+    if (_config.pipelined && !_config.headless) {
+        start_simulation();
+    }
+
     while (_is_running) {
-        handle_events();
-        update(0.0f);
-        render();
+        tick();
+        _limiter.wait();
+
+        // 下一帧要用的 arena 上次用于前一帧，此时它的模拟和渲染都已结束。
+        _frame_arenas[(_clock.frame() + 1) % 2].reset();
+        track_allocations();
+
+        if (g_stop_requested ||
+            (_config.max_frames > 0 && _clock.frame() >= _config.max_frames)) {
+            _is_running = false;
+        }
+    }
+
+    if (_config.headless) {
+        double elapsed = _clock.elapsed();
+        spdlog::info("headless run finished: {} frames in {:.3f} s, "
+                     "{:.3f} ms/frame.",
+                     _clock.frame(), elapsed,
+                     _clock.frame() > 0 ? elapsed * 1000.0 / _clock.frame()
+                                        : 0.0);
+    }
+
+    spdlog::info("frame arena high watermark: {} KB / {} KB.",
+                 std::max(_frame_arenas[0].high_watermark(),
+                          _frame_arenas[1].high_watermark()) /
+                     1024,
+                 std::max(_frame_arenas[0].capacity(),
+                          _frame_arenas[1].capacity()) /
+                     1024);
+
+    if (AllocTracker::enabled()) {
+        spdlog::info("steady-state allocations: {} ({} bytes), worst frame {}.",
+                     _steady_allocs.count, _steady_allocs.bytes,
+                     _worst_frame_allocs);
+    }
+
+    if (_config.profile && !Profiler::write_chrome_trace(_config.trace_path)) {
+        spdlog::warn("profiler capture lost.");
     }
 
     clean();
@@ -39,15 +102,25 @@ bool App::init() {
         return false;
     }
 
-    if (!init_sdl()) {
-        return false;
+    if (_config.headless) {
+        std::signal(SIGINT, request_stop);
+        std::signal(SIGTERM, request_stop);
+        spdlog::info("running headless, no window or gl context.");
+    } else {
+        if (!init_sdl()) {
+            return false;
+        }
+
+        if (!init_gl()) {
+            return false;
+        }
     }
 
-    if (!init_gl()) {
+    if (!init_handlers()) {
         return false;
     }
 
-    if (!init_handlers()) {
+    if (!init_recording()) {
         return false;
     }
 
@@ -55,18 +128,30 @@ bool App::init() {
 }
 
 bool App::init_log() {
-#ifdef NDEBUG
-    spdlog::set_level(spdlog::level::info);
-#else
-    spdlog::set_level(spdlog::level::trace);
-#endif
+    if (!init_logging(_config.log)) {
+        return false;
+    }
+
+    Profiler::set_thread_name("main");
+    Profiler::set_enabled(_config.profile);
+    _frame_stats.set_interval(_config.stats_interval);
+    _limiter.set_target_fps(_config.target_fps);
+    if (_config.target_fps > 0) {
+        _frame_stats.set_target(1.0f / static_cast<float>(_config.target_fps));
+    }
+
+    AllocTracker::set_assert(_config.alloc_assert);
+    if (_config.alloc_assert && !AllocTracker::enabled()) {
+        spdlog::warn("allocation tracking is not compiled in, "
+                     "--alloc-assert ignored.");
+    }
 
     return true;
 }
 
 bool App::init_sdl() {
-    if (!SDL_Init(SDL_INIT_VIDEO)) {
-        spdlog::error("sdl init failed: ", SDL_GetError());
+    if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMEPAD)) {
+        spdlog::error("sdl init failed: {}", SDL_GetError());
         return false;
     }
 
@@ -75,59 +160,375 @@ bool App::init_sdl() {
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
 
-    SDL_Window* _window = SDL_CreateWindow(
-        "anim", 1280, 720, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+    _window = SDL_CreateWindow("anim", 1280, 720,
+                               SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
     if (!_window) {
-        spdlog::error("sdl create window failed: ", SDL_GetError());
+        spdlog::error("sdl create window failed: {}", SDL_GetError());
         return false;
     }
 
     _gl_context = SDL_GL_CreateContext(_window);
     if (!_gl_context) {
-        spdlog::error("sdl create gl context failed: ", SDL_GetError());
+        spdlog::error("sdl create gl context failed: {}", SDL_GetError());
         return false;
     }
 
-    if (!SDL_GL_SetSwapInterval(1)) {
-        spdlog::error("sdl set vsync failed: ", SDL_GetError());
-        return false;
-    }
+    init_vsync();
 
     return true;
 }
 
+void App::init_vsync() {
+    // 垂直同步设置失败不影响运行，只是帧率不再受显示器约束。
+    int interval = 0;
+    switch (_config.vsync) {
+        case VsyncMode::Off:
+            interval = 0;
+            break;
+        case VsyncMode::On:
+            interval = 1;
+            break;
+        case VsyncMode::Adaptive:
+            if (SDL_GL_SetSwapInterval(-1)) {
+                spdlog::info("vsync: adaptive.");
+                return;
+            }
+            spdlog::warn("adaptive vsync unsupported ({}), falling back to on.",
+                         SDL_GetError());
+            interval = 1;
+            break;
+    }
+
+    if (!SDL_GL_SetSwapInterval(interval)) {
+        spdlog::warn("sdl set swap interval {} failed: {}", interval,
+                     SDL_GetError());
+        return;
+    }
+    spdlog::info("vsync: {}.", interval ? "on" : "off");
+}
+
 bool App::init_gl() {
     return gladLoadGLLoader(
         reinterpret_cast<GLADloadproc>(SDL_GL_GetProcAddress));
 }
 
 bool App::init_handlers() {
-    _scene_handler = std::make_unique<SceneHandler>();
+    _job_system = std::make_unique<JobSystem>();
+    if (!_job_system->init(_config.worker_count)) {
+        spdlog::error("job system init failed.");
+        return false;
+    }
+
+    // 两个缓冲交替使用，容量只会增长，稳定后收集事件不再分配。
+    _events.reserve(256);
+    _sim_events.reserve(256);
+
+    for (FrameArena& arena : _frame_arenas) {
+        arena.init(_config.frame_arena_size);
+    }
+
+    _asset_loader = std::make_unique<AssetLoader>();
+    if (!_asset_loader->init(_job_system.get(), _config.asset_loader)) {
+        spdlog::error("asset loader init failed.");
+        return false;
+    }
+
+    _asset_registry = std::make_unique<AssetRegistry>();
+    if (!_asset_registry->init(_asset_loader.get(), _config.asset_registry)) {
+        spdlog::error("asset registry init failed.");
+        return false;
+    }
+
+    _scene_handler = std::make_unique<SceneHandler>(
+        _job_system.get(), _asset_loader.get(), _asset_registry.get());
+
+    return true;
+}
+
+bool App::init_recording() {
+    if (!_config.replay_path.empty()) {
+        if (!_player.open(_config.replay_path)) {
+            return false;
+        }
+
+        // 固定步长的设置决定了每帧 update 的次数，必须和录制时一致。
+        const InputRecordingHeader& header = _player.header();
+        if (header.fixed_update_rate != _config.fixed_update_rate ||
+            header.max_updates_per_frame != _config.max_updates_per_frame) {
+            spdlog::warn("replay overrides fixed update rate {} -> {}.",
+                         _config.fixed_update_rate, header.fixed_update_rate);
+            _config.fixed_update_rate = header.fixed_update_rate;
+            _config.max_updates_per_frame = header.max_updates_per_frame;
+        }
+    }
+
+    if (!_config.record_path.empty()) {
+        InputRecordingHeader header{};
+        header.magic = INPUT_RECORDING_MAGIC;
+        header.version = INPUT_RECORDING_VERSION;
+        header.fixed_update_rate = _config.fixed_update_rate;
+        header.max_updates_per_frame = _config.max_updates_per_frame;
+        if (!_recorder.open(_config.record_path, header)) {
+            return false;
+        }
+    }
 
     return true;
 }
 
 void App::handle_events() {
+    ANIM_PROFILE_SCOPE("App::handle_events");
+
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_EventType::SDL_EVENT_QUIT) {
             _is_running = false;
+        } else if (event.type == SDL_EventType::SDL_EVENT_GAMEPAD_ADDED) {
+            if (!SDL_OpenGamepad(event.gdevice.which)) {
+                spdlog::warn("sdl open gamepad failed: {}", SDL_GetError());
+            }
+        } else if (event.type == SDL_EventType::SDL_EVENT_GAMEPAD_REMOVED) {
+            SDL_CloseGamepad(SDL_GetGamepadFromID(event.gdevice.which));
+        } else if (event.type == SDL_EventType::SDL_EVENT_KEY_DOWN &&
+                   event.key.key == SDLK_F9 && !event.key.repeat) {
+            if (!Profiler::enabled()) {
+                spdlog::info("profiler capture started.");
+                Profiler::set_enabled(true);
+            } else {
+                // 再按一次结束采集，之后只有进行中的作用域还会写入。
+                Profiler::set_enabled(false);
+                spdlog::info("profiler capture stopped.");
+                if (!Profiler::write_chrome_trace(_config.trace_path)) {
+                    spdlog::warn("profiler capture failed.");
+                }
+            }
         }
+
+        _events.push_back(event);
+    }
+}
+
+void App::tick() {
+    ANIM_PROFILE_SCOPE("App::tick");
+
+    float frame_time = std::min(_clock.tick(), _config.max_frame_time);
+    _frame_stats.add(_clock.delta());
+
+    // 无窗口且不回放时每帧正好走一个固定步长，事件为空，
+    // 同样经过 simulate，录制和输入状态与有窗口时一致。
+    if (_config.headless && !_player.active() &&
+        _config.fixed_update_rate > 0) {
+        frame_time = 1.0f / static_cast<float>(_config.fixed_update_rate);
     }
 
-    _scene_handler->handle_events(event);
+    if (!_config.headless) {
+        handle_events();
+    }
+
+    // 回放时用录像里的帧时间和事件代替真实输入，退出之类的窗口事件仍然生效。
+    if (_player.active()) {
+        _events.clear();
+        if (!_player.read_frame(frame_time, _events)) {
+            spdlog::info("input replay finished after {} frames.",
+                         _clock.frame() - 1);
+            _is_running = false;
+            return;
+        }
+    }
+
+    if (!_config.pipelined || _config.headless) {
+        sync_frame_boundary();
+        _sim_events.swap(_events);
+        _events.clear();
+        simulate(_clock.frame(), frame_time);
+        if (!_config.headless) {
+            render();
+        }
+        return;
+    }
+
+    // 先等上一帧的模拟结束再提交这一帧，渲染与模拟并行，
+    // 画面比模拟晚一帧，帧耗时取两者较大者。
+    // 模拟空闲的间隙也是替换场景、发布资源的帧边界。
+    wait_simulation();
+    sync_frame_boundary();
+    submit_simulation(_clock.frame(), frame_time);
+    render();
 }
 
-void App::update(float dt) { _scene_handler->update(dt); }
+void App::sync_frame_boundary() {
+    _scene_handler->finish_switch();
+
+    // 先切换场景，新场景也能收到这一帧完成的资源。
+    // 资源先登记进注册表，场景在回调里就能按名字查到句柄。
+    _asset_loader->drain(
+        [](void* user, AssetLoadHandle handle, const AssetFile* file) {
+            auto* app = static_cast<App*>(user);
+            app->_asset_registry->publish(handle, file);
+            app->_scene_handler->asset_loaded(handle, file);
+        },
+        this);
+
+    // 上一帧读取的资源都已经用完，这里销毁不再被引用的。
+    _asset_registry->collect();
+}
+
+void App::simulate(uint64_t frame, float frame_time) {
+    ANIM_PROFILE_SCOPE("App::simulate");
+
+    _recorder.write_frame(frame_time, _sim_events);
+
+    _input.begin_frame();
+    for (const SDL_Event& event : _sim_events) {
+        _input.process(event);
+    }
+    _scene_handler->handle_events(_sim_events, _input);
+    _sim_events.clear();
+
+    FrameArena& arena = _frame_arenas[frame % 2];
+    if (_config.fixed_update_rate == 0) {
+        update(frame_time, arena);
+        _scene_handler->publish(frame, 1.0f);
+        return;
+    }
+
+    float step = 1.0f / static_cast<float>(_config.fixed_update_rate);
+    _accumulator += frame_time;
+
+    unsigned int updates = 0;
+    while (_accumulator >= step && updates < _config.max_updates_per_frame) {
+        update(step, arena);
+        _accumulator -= step;
+        ++updates;
+    }
+
+    if (_accumulator >= step) {
+        ANIM_LOG_RATE_LIMITED(
+            spdlog::level::warn, 1000,
+            "fixed update fell behind, dropped {:.1f} ms.",
+            (_accumulator - std::fmod(_accumulator, step)) * 1000.0f);
+        _accumulator = std::fmod(_accumulator, step);
+    }
+
+    _scene_handler->publish(frame, _accumulator / step);
+}
+
+void App::update(float dt, FrameArena& arena) {
+    ANIM_PROFILE_SCOPE("App::update");
+
+    _scene_handler->update(dt, arena);
+}
 
 void App::render() {
+    ANIM_PROFILE_SCOPE("App::render");
+
     _scene_handler->render();
 
     SDL_GL_SwapWindow(_window);
 }
 
+void App::start_simulation() {
+    _sim_stop = false;
+    _sim_busy = false;
+    _sim_thread = std::thread(&App::simulation_main, this);
+}
+
+void App::submit_simulation(uint64_t frame, float frame_time) {
+    wait_simulation();
+
+    std::lock_guard<std::mutex> lock(_sim_mutex);
+    _sim_events.swap(_events);
+    _events.clear();
+    _sim_frame = frame;
+    _sim_frame_time = frame_time;
+    _sim_busy = true;
+    _sim_cv.notify_all();
+}
+
+void App::wait_simulation() {
+    ANIM_PROFILE_SCOPE("App::wait_simulation");
+
+    std::unique_lock<std::mutex> lock(_sim_mutex);
+    _sim_cv.wait(lock, [this] { return !_sim_busy; });
+}
+
+void App::stop_simulation() {
+    if (!_sim_thread.joinable()) {
+        return;
+    }
+
+    wait_simulation();
+    {
+        std::lock_guard<std::mutex> lock(_sim_mutex);
+        _sim_stop = true;
+    }
+    _sim_cv.notify_all();
+    _sim_thread.join();
+}
+
+void App::simulation_main() {
+    Profiler::set_thread_name("simulation");
+
+    std::unique_lock<std::mutex> lock(_sim_mutex);
+    while (true) {
+        _sim_cv.wait(lock, [this] { return _sim_busy || _sim_stop; });
+        if (_sim_stop) {
+            return;
+        }
+
+        uint64_t frame = _sim_frame;
+        float frame_time = _sim_frame_time;
+        lock.unlock();
+        simulate(frame, frame_time);
+        lock.lock();
+
+        _sim_busy = false;
+        _sim_cv.notify_all();
+    }
+}
+
+void App::track_allocations() {
+    if (!AllocTracker::enabled()) {
+        return;
+    }
+
+    // 这里不逐帧写日志，日志本身也会分配，会把统计搅乱。
+    AllocStats stats = AllocTracker::end_frame();
+    if (_clock.frame() < ALLOC_WARMUP_FRAMES) {
+        return;
+    }
+    if (_clock.frame() == ALLOC_WARMUP_FRAMES) {
+        AllocTracker::set_armed(true);
+        return;
+    }
+
+    _steady_allocs.count += stats.count;
+    _steady_allocs.bytes += stats.bytes;
+    _worst_frame_allocs = std::max(_worst_frame_allocs, stats.count);
+}
+
 void App::clean() {
-    _scene_handler->clean();
+    AllocTracker::set_armed(false);
+
+    stop_simulation();
+    _recorder.close();
+    _player.close();
+
+    if (_scene_handler) {
+        _scene_handler->clean();
+    }
+
+    // 场景退出后才没有人再引用已加载的资源。
+    if (_asset_registry) {
+        _asset_registry->shutdown();
+    }
+    if (_asset_loader) {
+        _asset_loader->shutdown();
+    }
+
+    if (_job_system) {
+        _job_system->shutdown();
+    }
 
     if (_gl_context) {
         SDL_GL_DestroyContext(_gl_context);
@@ -1,14 +1,31 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+#include <SDL3/SDL_events.h>
 #include <SDL3/SDL_video.h>
 
+#include "../asset/asset_loader.h"
+#include "../asset/asset_registry.h"
+#include "../core/alloc_tracker.h"
+#include "../core/frame_arena.h"
+#include "../core/job_system.h"
+#include "../core/profiler.h"
 #include "../scene/scene.h"
+#include "app_config.h"
+#include "frame_clock.h"
+#include "frame_limiter.h"
+#include "input_recording.h"
 
 class App final {
 public:
     App();
+    explicit App(const AppConfig& config);
     ~App();
     explicit App(const App&) = delete;
     explicit App(App&&) = delete;
@@ -23,16 +40,58 @@ private:
     [[nodiscard]] bool init_log();
     [[nodiscard]] bool init_sdl();
     [[nodiscard]] bool init_gl();
+    void init_vsync();
     [[nodiscard]] bool init_handlers();
+    [[nodiscard]] bool init_recording();
 
     void handle_events();
-    void update(float dt);
+    void tick();
+    void sync_frame_boundary();
+    void simulate(uint64_t frame, float frame_time);
+    void update(float dt, FrameArena& arena);
     void render();
+    void track_allocations();
     void clean();
 
+    void start_simulation();
+    void submit_simulation(uint64_t frame, float frame_time);
+    void wait_simulation();
+    void stop_simulation();
+    void simulation_main();
+
+    AppConfig _config;
+    FrameClock _clock;
+    FrameLimiter _limiter;
+    FrameStats _frame_stats;
+    float _accumulator;
+
+    // 按帧号奇偶轮换，流水线模式下模拟下一帧时上一帧的数据仍在渲染。
+    FrameArena _frame_arenas[2];
+
+    AllocStats _steady_allocs;
+    uint64_t _worst_frame_allocs;
+
+    // 主线程收集的事件，提交时整体交给模拟一侧的 _sim_events。
+    std::vector<SDL_Event> _events;
+    std::vector<SDL_Event> _sim_events;
+    InputState _input;
+    InputRecorder _recorder;
+    InputPlayer _player;
+
+    std::thread _sim_thread;
+    std::mutex _sim_mutex;
+    std::condition_variable _sim_cv;
+    uint64_t _sim_frame;
+    float _sim_frame_time;
+    bool _sim_busy;
+    bool _sim_stop;
+
     bool _is_running;
     SDL_Window* _window;
     SDL_GLContext _gl_context;
 
+    std::unique_ptr<JobSystem> _job_system;
+    std::unique_ptr<AssetLoader> _asset_loader;
+    std::unique_ptr<AssetRegistry> _asset_registry;
     std::unique_ptr<SceneHandler> _scene_handler;
 };
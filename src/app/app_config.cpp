@@ -0,0 +1,115 @@
+#include "app_config.h"
+
+#include <cstdlib>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+bool parse_uint(const char* text, uint64_t& out) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+bool parse_vsync(const std::string& text, VsyncMode& out) {
+    if (text == "off") {
+        out = VsyncMode::Off;
+    } else if (text == "on") {
+        out = VsyncMode::On;
+    } else if (text == "adaptive") {
+        out = VsyncMode::Adaptive;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parse_overflow(const std::string& text, LogOverflow& out) {
+    if (text == "block") {
+        out = LogOverflow::Block;
+    } else if (text == "drop-oldest") {
+        out = LogOverflow::DropOldest;
+    } else if (text == "drop-newest") {
+        out = LogOverflow::DropNewest;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool parse_app_args(int argc, char** argv, AppConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        uint64_t value = 0;
+
+        if (arg == "--headless") {
+            config.headless = true;
+        } else if (arg == "--frames" && has_value &&
+                   parse_uint(argv[i + 1], value)) {
+            config.max_frames = value;
+            ++i;
+        } else if (arg == "--fixed-rate" && has_value &&
+                   parse_uint(argv[i + 1], value)) {
+            config.fixed_update_rate = static_cast<unsigned int>(value);
+            ++i;
+        } else if (arg == "--vsync" && has_value &&
+                   parse_vsync(argv[i + 1], config.vsync)) {
+            ++i;
+        } else if (arg == "--fps" && has_value &&
+                   parse_uint(argv[i + 1], value)) {
+            config.target_fps = static_cast<unsigned int>(value);
+            ++i;
+        } else if (arg == "--pipelined") {
+            config.pipelined = true;
+        } else if (arg == "--alloc-assert") {
+            config.alloc_assert = true;
+        } else if (arg == "--record" && has_value) {
+            config.record_path = argv[i + 1];
+            ++i;
+        } else if (arg == "--replay" && has_value) {
+            config.replay_path = argv[i + 1];
+            ++i;
+        } else if (arg == "--sync-log") {
+            config.log.async = false;
+        } else if (arg == "--log-overflow" && has_value &&
+                   parse_overflow(argv[i + 1], config.log.overflow)) {
+            ++i;
+        } else if (arg == "--profile") {
+            config.profile = true;
+        } else if (arg == "--trace" && has_value) {
+            config.profile = true;
+            config.trace_path = argv[i + 1];
+            ++i;
+        } else if (arg == "--stats" && has_value &&
+                   parse_uint(argv[i + 1], value)) {
+            config.stats_interval = static_cast<unsigned int>(value);
+            ++i;
+        } else if (arg == "--workers" && has_value &&
+                   parse_uint(argv[i + 1], value)) {
+            config.worker_count = static_cast<unsigned int>(value);
+            ++i;
+        } else if (arg == "--io-threads" && has_value &&
+                   parse_uint(argv[i + 1], value) && value > 0) {
+            config.asset_loader.io_threads = static_cast<unsigned int>(value);
+            ++i;
+        } else if (arg == "--no-io-uring") {
+            config.asset_loader.use_io_uring = false;
+        } else if (arg == "--hot-reload") {
+            config.asset_loader.hot_reload = true;
+        } else {
+            spdlog::error("unknown or invalid argument: {}", arg);
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../asset/asset_loader.h"
+#include "../asset/asset_registry.h"
+#include "../core/log.h"
+
+enum class VsyncMode {
+    Off,
+    On,
+    // 晚到的帧立即交换而不是等下一个垂直同步，驱动不支持时退回 On。
+    Adaptive,
+};
+
+struct AppConfig {
+    bool headless = false;
+    uint64_t max_frames = 0;
+
+    unsigned int fixed_update_rate = 0;
+    unsigned int max_updates_per_frame = 8;
+    float max_frame_time = 0.25f;
+
+    VsyncMode vsync = VsyncMode::On;
+    // 0 表示不限帧，可以和 vsync 叠加使用。
+    unsigned int target_fps = 0;
+
+    // 模拟放到独立线程，主线程只负责事件和渲染。
+    bool pipelined = false;
+
+    size_t frame_arena_size = 4 * 1024 * 1024;
+
+    // 需要以 ANIM_TRACK_ALLOCATIONS 编译，否则没有效果。
+    bool alloc_assert = false;
+
+    LogSettings log;
+
+    // 录制场景收到的帧时间和输入事件，或者回放之前的录像代替真实输入。
+    std::string record_path;
+    std::string replay_path;
+
+    bool profile = false;
+    std::string trace_path = "anim_trace.json";
+    unsigned int stats_interval = 0;
+
+    // 0 表示硬件线程数减一，主线程本身也参与执行任务。
+    unsigned int worker_count = 0;
+
+    AssetLoaderSettings asset_loader;
+    AssetRegistrySettings asset_registry;
+};
+
+[[nodiscard]] bool parse_app_args(int argc, char** argv, AppConfig& config);
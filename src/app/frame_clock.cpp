@@ -0,0 +1,22 @@
+#include "frame_clock.h"
+
+FrameClock::FrameClock() { reset(); }
+
+void FrameClock::reset() {
+    _start = Clock::now();
+    _last = _start;
+    _delta = 0.0f;
+    _frame = 0;
+}
+
+float FrameClock::tick() {
+    Clock::time_point now = Clock::now();
+    _delta = std::chrono::duration<float>(now - _last).count();
+    _last = now;
+    ++_frame;
+    return _delta;
+}
+
+double FrameClock::elapsed() const {
+    return std::chrono::duration<double>(_last - _start).count();
+}
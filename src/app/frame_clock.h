@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+class FrameClock {
+public:
+    FrameClock();
+
+    void reset();
+    float tick();
+
+    float delta() const { return _delta; }
+    double elapsed() const;
+    uint64_t frame() const { return _frame; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point _start;
+    Clock::time_point _last;
+    float _delta;
+    uint64_t _frame;
+};
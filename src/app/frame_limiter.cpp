@@ -0,0 +1,42 @@
+#include "frame_limiter.h"
+
+#include <thread>
+
+namespace {
+
+// 大多数平台 sleep 的误差在 1 ms 左右，留出余量后改为自旋。
+constexpr std::chrono::microseconds SPIN_THRESHOLD{2000};
+
+} // namespace
+
+FrameLimiter::FrameLimiter() : _fps{0}, _period{0} { reset(); }
+
+void FrameLimiter::set_target_fps(unsigned int fps) {
+    _fps = fps;
+    _period = fps > 0 ? std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double>(1.0 / fps))
+                      : Clock::duration{0};
+    reset();
+}
+
+void FrameLimiter::reset() { _next = Clock::now(); }
+
+void FrameLimiter::wait() {
+    if (_fps == 0) {
+        return;
+    }
+
+    _next += _period;
+    Clock::time_point now = Clock::now();
+    if (_next <= now) {
+        _next = now;
+        return;
+    }
+
+    if (_next - now > SPIN_THRESHOLD) {
+        std::this_thread::sleep_for(_next - now - SPIN_THRESHOLD);
+    }
+    while (Clock::now() < _next) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chrono>
+
+// 按目标帧率补足每帧剩余时间。先 sleep 到截止时间前一小段，剩下的自旋，
+// 避开系统定时器的粒度误差；落后超过一帧时不追赶，直接以当前时间重新计时。
+class FrameLimiter {
+public:
+    FrameLimiter();
+
+    void set_target_fps(unsigned int fps);
+    unsigned int target_fps() const { return _fps; }
+
+    void reset();
+    void wait();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    unsigned int _fps;
+    Clock::duration _period;
+    Clock::time_point _next;
+};
@@ -0,0 +1,182 @@
+#include "input_recording.h"
+
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// 只记录会影响场景的输入事件，返回 0 表示跳过。
+uint16_t event_payload_size(uint32_t type) {
+    switch (type) {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            return sizeof(SDL_KeyboardEvent);
+        case SDL_EVENT_MOUSE_MOTION:
+            return sizeof(SDL_MouseMotionEvent);
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            return sizeof(SDL_MouseButtonEvent);
+        case SDL_EVENT_MOUSE_WHEEL:
+            return sizeof(SDL_MouseWheelEvent);
+        case SDL_EVENT_GAMEPAD_ADDED:
+        case SDL_EVENT_GAMEPAD_REMOVED:
+            return sizeof(SDL_GamepadDeviceEvent);
+        case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
+        case SDL_EVENT_GAMEPAD_BUTTON_UP:
+            return sizeof(SDL_GamepadButtonEvent);
+        case SDL_EVENT_GAMEPAD_AXIS_MOTION:
+            return sizeof(SDL_GamepadAxisEvent);
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+InputRecorder::InputRecorder() : _file{nullptr}, _frames{0} {}
+
+InputRecorder::~InputRecorder() { close(); }
+
+bool InputRecorder::open(const std::string& path,
+                         const InputRecordingHeader& header) {
+    close();
+
+    _file = std::fopen(path.c_str(), "wb");
+    if (!_file) {
+        spdlog::error("open input recording failed: {}", path);
+        return false;
+    }
+
+    // 录制期间按帧写入，缓冲大一些，减少写文件的次数。
+    std::setvbuf(_file, nullptr, _IOFBF, 1 << 16);
+    if (std::fwrite(&header, sizeof(header), 1, _file) != 1) {
+        spdlog::error("write input recording failed: {}", path);
+        close();
+        return false;
+    }
+
+    _frames = 0;
+    spdlog::info("recording input to {}.", path);
+    return true;
+}
+
+void InputRecorder::close() {
+    if (!_file) {
+        return;
+    }
+
+    std::fclose(_file);
+    _file = nullptr;
+    spdlog::info("input recording closed after {} frames.", _frames);
+}
+
+void InputRecorder::write_frame(float frame_time,
+                                Span<const SDL_Event> events) {
+    if (!_file) {
+        return;
+    }
+
+    uint32_t count = 0;
+    for (const SDL_Event& event : events) {
+        if (event_payload_size(event.type) > 0) {
+            ++count;
+        }
+    }
+
+    bool ok = std::fwrite(&frame_time, sizeof(frame_time), 1, _file) == 1 &&
+              std::fwrite(&count, sizeof(count), 1, _file) == 1;
+    for (const SDL_Event& event : events) {
+        uint16_t size = event_payload_size(event.type);
+        if (!ok || size == 0) {
+            continue;
+        }
+        ok = std::fwrite(&event.type, sizeof(event.type), 1, _file) == 1 &&
+             std::fwrite(&size, sizeof(size), 1, _file) == 1 &&
+             std::fwrite(&event, size, 1, _file) == 1;
+    }
+
+    if (!ok) {
+        spdlog::error("write input recording failed, recording stopped.");
+        close();
+        return;
+    }
+    ++_frames;
+}
+
+InputPlayer::InputPlayer() : _offset{0}, _header{} {}
+
+bool InputPlayer::open(const std::string& path) {
+    close();
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        spdlog::error("open input recording failed: {}", path);
+        return false;
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    if (size > 0) {
+        _data.resize(static_cast<size_t>(size));
+        if (std::fread(_data.data(), 1, _data.size(), file) != _data.size()) {
+            _data.clear();
+        }
+    }
+    std::fclose(file);
+
+    if (!read(&_header, sizeof(_header)) ||
+        _header.magic != INPUT_RECORDING_MAGIC ||
+        _header.version != INPUT_RECORDING_VERSION) {
+        spdlog::error("invalid input recording: {}", path);
+        close();
+        return false;
+    }
+
+    spdlog::info("replaying input from {} ({} bytes).", path, _data.size());
+    return true;
+}
+
+void InputPlayer::close() {
+    _data.clear();
+    _data.shrink_to_fit();
+    _offset = 0;
+}
+
+bool InputPlayer::read_frame(float& frame_time,
+                             std::vector<SDL_Event>& events) {
+    uint32_t count = 0;
+    if (!read(&frame_time, sizeof(frame_time)) ||
+        !read(&count, sizeof(count))) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t type = 0;
+        uint16_t size = 0;
+        if (!read(&type, sizeof(type)) || !read(&size, sizeof(size)) ||
+            size > sizeof(SDL_Event) || size != event_payload_size(type)) {
+            spdlog::error("corrupt input recording at byte {}.", _offset);
+            return false;
+        }
+
+        SDL_Event event;
+        std::memset(&event, 0, sizeof(event));
+        if (!read(&event, size)) {
+            return false;
+        }
+        events.push_back(event);
+    }
+
+    return true;
+}
+
+bool InputPlayer::read(void* out, size_t size) {
+    if (_data.size() - _offset < size) {
+        return false;
+    }
+    std::memcpy(out, _data.data() + _offset, size);
+    _offset += size;
+    return true;
+}
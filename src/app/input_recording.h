@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL_events.h>
+
+#include "../core/span.h"
+
+// 录像文件：文件头之后逐帧记录 frame_time 和场景收到的事件。
+// 只保存不含指针的输入类事件，按本机字节序写入，不用于跨平台交换。
+//
+//   header: magic, version, fixed_update_rate, max_updates_per_frame
+//   frame:  float frame_time, uint32 event_count,
+//           event_count * (uint32 type, uint16 size, uint8 payload[size])
+constexpr uint32_t INPUT_RECORDING_MAGIC = 0x43455241; // "AREC"
+constexpr uint32_t INPUT_RECORDING_VERSION = 1;
+
+struct InputRecordingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t fixed_update_rate;
+    uint32_t max_updates_per_frame;
+};
+
+class InputRecorder final {
+public:
+    InputRecorder();
+    ~InputRecorder();
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    [[nodiscard]] bool open(const std::string& path,
+                            const InputRecordingHeader& header);
+    void close();
+    bool active() const { return _file != nullptr; }
+
+    void write_frame(float frame_time, Span<const SDL_Event> events);
+
+private:
+    std::FILE* _file;
+    uint64_t _frames;
+};
+
+class InputPlayer final {
+public:
+    InputPlayer();
+
+    // 整个文件一次读进内存，回放期间不再做 IO。
+    [[nodiscard]] bool open(const std::string& path);
+    void close();
+    bool active() const { return !_data.empty(); }
+
+    const InputRecordingHeader& header() const { return _header; }
+
+    // 读取下一帧，事件追加到 events 末尾；录像结束或数据损坏时返回 false。
+    bool read_frame(float& frame_time, std::vector<SDL_Event>& events);
+
+private:
+    bool read(void* out, size_t size);
+
+    std::vector<uint8_t> _data;
+    size_t _offset;
+    InputRecordingHeader _header;
+};
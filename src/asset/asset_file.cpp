@@ -0,0 +1,504 @@
+#include "asset_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+
+#include "../core/hash.h"
+
+namespace {
+
+constexpr uint32_t STREAM_ALIGNMENT = 16;
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// 把数组依次追加到块数据末尾，返回相对块首的偏移。
+class ChunkBuilder {
+public:
+    template <typename Header>
+    Header& header() {
+        if (_data.empty()) {
+            _data.resize(sizeof(Header), 0);
+        }
+        return *reinterpret_cast<Header*>(_data.data());
+    }
+
+    uint32_t append(const void* data, size_t size) {
+        if (size == 0) {
+            return 0;
+        }
+        size_t offset = align_up(_data.size(), STREAM_ALIGNMENT);
+        _data.resize(offset + size, 0);
+        std::memcpy(_data.data() + offset, data, size);
+        return static_cast<uint32_t>(offset);
+    }
+
+    std::vector<uint8_t>& data() { return _data; }
+
+private:
+    std::vector<uint8_t> _data;
+};
+
+AssetTransform to_asset(const Transform& t) {
+    AssetTransform out;
+    out.position[0] = t.position.x;
+    out.position[1] = t.position.y;
+    out.position[2] = t.position.z;
+    out.rotation[0] = t.rotation.x;
+    out.rotation[1] = t.rotation.y;
+    out.rotation[2] = t.rotation.z;
+    out.rotation[3] = t.rotation.w;
+    out.scale[0] = t.scale.x;
+    out.scale[1] = t.scale.y;
+    out.scale[2] = t.scale.z;
+    return out;
+}
+
+Transform from_asset(const AssetTransform& t) {
+    return Transform(Vec3(t.position[0], t.position[1], t.position[2]),
+                     Quat(t.rotation[0], t.rotation[1], t.rotation[2],
+                          t.rotation[3]),
+                     Vec3(t.scale[0], t.scale[1], t.scale[2]));
+}
+
+uint64_t header_checksum(const uint8_t* data, const AssetFileHeader& header) {
+    AssetFileHeader copy = header;
+    copy.header_checksum = 0;
+    uint64_t hash = fnv1a64(&copy, sizeof(copy));
+    hash = fnv1a64(data + header.chunk_table_offset,
+                   sizeof(AssetChunk) * header.num_chunks, hash);
+    return fnv1a64(data + header.string_table_offset,
+                   header.string_table_size, hash);
+}
+
+bool in_range(uint64_t offset, uint64_t size, uint64_t limit) {
+    return offset <= limit && size <= limit - offset;
+}
+
+} // namespace
+
+int SkeletonView::parent(unsigned int index) const {
+    return reinterpret_cast<const int32_t*>(_base +
+                                            _header->parents_offset)[index];
+}
+
+Transform SkeletonView::rest_transform(unsigned int index) const {
+    return from_asset(reinterpret_cast<const AssetTransform*>(
+        _base + _header->rest_offset)[index]);
+}
+
+Transform SkeletonView::bind_transform(unsigned int index) const {
+    return from_asset(reinterpret_cast<const AssetTransform*>(
+        _base + _header->bind_offset)[index]);
+}
+
+const char* SkeletonView::joint_name(unsigned int index) const {
+    const auto* offsets = reinterpret_cast<const uint32_t*>(
+        _base + _header->name_offsets_offset);
+    return reinterpret_cast<const char*>(_base + _header->names_offset +
+                                         offsets[index]);
+}
+
+void SkeletonView::to_skeleton(Skeleton& out) const {
+    unsigned int num_joints = size();
+    Pose rest(num_joints);
+    Pose bind(num_joints);
+    std::vector<std::string> names(num_joints);
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        rest.set_parent(i, parent(i));
+        bind.set_parent(i, parent(i));
+        rest.set_local_transform(i, rest_transform(i));
+        bind.set_local_transform(i, bind_transform(i));
+        names[i] = joint_name(i);
+    }
+    out.set(rest, bind, names);
+}
+
+void AssetWriter::add_skeleton(const std::string& name,
+                               const Skeleton& skeleton) {
+    unsigned int num_joints = skeleton.size();
+    std::vector<int32_t> parents(num_joints);
+    std::vector<AssetTransform> rest(num_joints);
+    std::vector<AssetTransform> bind(num_joints);
+    std::vector<uint32_t> name_offsets(num_joints);
+    std::string names;
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        parents[i] = skeleton.rest_pose().parent(i);
+        rest[i] = to_asset(skeleton.rest_pose().local_transform(i));
+        bind[i] = to_asset(skeleton.bind_pose().local_transform(i));
+        name_offsets[i] = static_cast<uint32_t>(names.size());
+        names += skeleton.joint_name(i);
+        names.push_back('\0');
+    }
+
+    ChunkBuilder builder;
+    builder.header<SkeletonChunkHeader>();
+    uint32_t parents_offset =
+        builder.append(parents.data(), parents.size() * sizeof(int32_t));
+    uint32_t rest_offset =
+        builder.append(rest.data(), rest.size() * sizeof(AssetTransform));
+    uint32_t bind_offset =
+        builder.append(bind.data(), bind.size() * sizeof(AssetTransform));
+    uint32_t name_offsets_offset = builder.append(
+        name_offsets.data(), name_offsets.size() * sizeof(uint32_t));
+    uint32_t names_offset = builder.append(names.data(), names.size());
+
+    SkeletonChunkHeader& header = builder.header<SkeletonChunkHeader>();
+    header.num_joints = num_joints;
+    header.parents_offset = parents_offset;
+    header.rest_offset = rest_offset;
+    header.bind_offset = bind_offset;
+    header.name_offsets_offset = name_offsets_offset;
+    header.names_offset = names_offset;
+    header.names_size = static_cast<uint32_t>(names.size());
+
+    _entries.push_back({AssetChunkType::Skeleton, name,
+                        std::move(builder.data())});
+}
+
+bool AssetWriter::add_clip(const std::string& name,
+                           const CompressedClip& clip) {
+    if (clip.empty()) {
+        spdlog::error("cannot write empty clip: {}", name);
+        return false;
+    }
+
+    _entries.push_back(
+        {AssetChunkType::Clip, name,
+         std::vector<uint8_t>(clip.data(), clip.data() + clip.size())});
+    return true;
+}
+
+void AssetWriter::add_mesh(const std::string& name,
+                           const SkinnedMeshData& mesh) {
+    ChunkBuilder builder;
+    builder.header<SkinnedMeshChunkHeader>();
+    uint32_t positions_offset = builder.append(
+        mesh.positions.data(), mesh.positions.size() * sizeof(float) * 3);
+    uint32_t normals_offset = builder.append(
+        mesh.normals.data(), mesh.normals.size() * sizeof(float) * 3);
+    uint32_t uvs_offset =
+        builder.append(mesh.uvs.data(), mesh.uvs.size() * sizeof(float) * 2);
+    uint32_t joints_offset = builder.append(
+        mesh.joints.data(), mesh.joints.size() * sizeof(uint16_t) * 4);
+    uint32_t weights_offset = builder.append(
+        mesh.weights.data(), mesh.weights.size() * sizeof(float) * 4);
+    uint32_t indices_offset = builder.append(
+        mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+
+    SkinnedMeshChunkHeader& header = builder.header<SkinnedMeshChunkHeader>();
+    header.num_vertices = static_cast<uint32_t>(mesh.positions.size());
+    header.num_indices = static_cast<uint32_t>(mesh.indices.size());
+    header.positions_offset = positions_offset;
+    header.normals_offset = normals_offset;
+    header.uvs_offset = uvs_offset;
+    header.joints_offset = joints_offset;
+    header.weights_offset = weights_offset;
+    header.indices_offset = indices_offset;
+
+    _entries.push_back({AssetChunkType::SkinnedMesh, name,
+                        std::move(builder.data())});
+}
+
+void AssetWriter::build(std::vector<uint8_t>& out) const {
+    std::vector<AssetChunk> table(_entries.size());
+    std::string strings;
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        table[i].type = static_cast<uint32_t>(_entries[i].type);
+        table[i].name_offset = static_cast<uint32_t>(strings.size());
+        strings += _entries[i].name;
+        strings.push_back('\0');
+    }
+
+    AssetFileHeader header{};
+    header.magic = ASSET_MAGIC;
+    header.version = ASSET_VERSION;
+    header.num_chunks = static_cast<uint32_t>(_entries.size());
+    header.chunk_table_offset = sizeof(AssetFileHeader);
+    header.string_table_offset = static_cast<uint32_t>(
+        header.chunk_table_offset + sizeof(AssetChunk) * table.size());
+    header.string_table_size = static_cast<uint32_t>(strings.size());
+
+    size_t offset = header.string_table_offset + strings.size();
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        const std::vector<uint8_t>& data = _entries[i].data;
+        offset = align_up(offset, ASSET_ALIGNMENT);
+        table[i].offset = offset;
+        table[i].size = data.size();
+        table[i].checksum = fnv1a64(data.data(), data.size());
+        offset += data.size();
+    }
+    header.file_size = offset;
+
+    out.assign(offset, 0);
+    std::memcpy(out.data() + header.chunk_table_offset, table.data(),
+                sizeof(AssetChunk) * table.size());
+    std::memcpy(out.data() + header.string_table_offset, strings.data(),
+                strings.size());
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        std::memcpy(out.data() + table[i].offset, _entries[i].data.data(),
+                    _entries[i].data.size());
+    }
+
+    header.header_checksum = header_checksum(out.data(), header);
+    std::memcpy(out.data(), &header, sizeof(header));
+}
+
+bool AssetWriter::write(const std::string& path) const {
+    std::vector<uint8_t> data;
+    build(data);
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        spdlog::error("open asset file for writing failed: {}", path);
+        return false;
+    }
+
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        spdlog::error("write asset file failed: {}", path);
+    }
+    return ok;
+}
+
+AssetFile::AssetFile() : _data{nullptr}, _size{0}, _header{nullptr} {}
+
+bool AssetFile::open(const std::string& path, AssetValidation validation) {
+    close();
+
+    if (!_file.open(path)) {
+        return false;
+    }
+
+    if (!attach(_file.data(), _file.size(), validation)) {
+        spdlog::error("invalid asset file: {}", path);
+        _file.close();
+        return false;
+    }
+    return true;
+}
+
+bool AssetFile::attach(const void* data, size_t size,
+                       AssetValidation validation) {
+    _data = static_cast<const uint8_t*>(data);
+    _size = size;
+    _header = reinterpret_cast<const AssetFileHeader*>(_data);
+
+    if (!_data || !validate(validation)) {
+        _data = nullptr;
+        _size = 0;
+        _header = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void AssetFile::close() {
+    _file.close();
+    _data = nullptr;
+    _size = 0;
+    _header = nullptr;
+}
+
+const char* AssetFile::chunk_name(unsigned int index) const {
+    return reinterpret_cast<const char*>(_data + _header->string_table_offset +
+                                         chunks()[index].name_offset);
+}
+
+int AssetFile::find(AssetChunkType type, const std::string& name) const {
+    for (unsigned int i = 0; i < num_chunks(); ++i) {
+        if (chunks()[i].type == static_cast<uint32_t>(type) &&
+            name == chunk_name(i)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool AssetFile::clip(unsigned int index, CompressedClip& out) const {
+    const AssetChunk& entry = chunk(index);
+    if (entry.type != static_cast<uint32_t>(AssetChunkType::Clip) ||
+        !out.attach(chunk_data(index), entry.size)) {
+        return false;
+    }
+    out.set_name(chunk_name(index));
+    return true;
+}
+
+SkeletonView AssetFile::skeleton(unsigned int index) const {
+    if (chunk(index).type != static_cast<uint32_t>(AssetChunkType::Skeleton)) {
+        return SkeletonView();
+    }
+    return SkeletonView(chunk_data(index));
+}
+
+SkinnedMeshView AssetFile::mesh(unsigned int index) const {
+    if (chunk(index).type !=
+        static_cast<uint32_t>(AssetChunkType::SkinnedMesh)) {
+        return SkinnedMeshView();
+    }
+    return SkinnedMeshView(chunk_data(index));
+}
+
+bool AssetFile::validate(AssetValidation validation) const {
+    if (_size < sizeof(AssetFileHeader) ||
+        reinterpret_cast<uintptr_t>(_data) % alignof(AssetFileHeader) != 0) {
+        return false;
+    }
+
+    const AssetFileHeader& header = *_header;
+    if (header.magic != ASSET_MAGIC) {
+        return false;
+    }
+    if (header.version != ASSET_VERSION) {
+        spdlog::error("asset version {} unsupported, expected {}.",
+                      header.version, ASSET_VERSION);
+        return false;
+    }
+    if (header.file_size != _size ||
+        !in_range(header.chunk_table_offset,
+                  static_cast<uint64_t>(sizeof(AssetChunk)) *
+                      header.num_chunks,
+                  _size) ||
+        header.chunk_table_offset % alignof(AssetChunk) != 0 ||
+        !in_range(header.string_table_offset, header.string_table_size,
+                  _size)) {
+        return false;
+    }
+
+    if (header_checksum(_data, header) != header.header_checksum) {
+        spdlog::error("asset header checksum mismatch.");
+        return false;
+    }
+
+    const char* strings =
+        reinterpret_cast<const char*>(_data + header.string_table_offset);
+    if (header.string_table_size > 0 &&
+        strings[header.string_table_size - 1] != '\0') {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < header.num_chunks; ++i) {
+        const AssetChunk& entry = chunks()[i];
+        if (entry.name_offset >= header.string_table_size ||
+            entry.offset % ASSET_ALIGNMENT != 0 ||
+            !in_range(entry.offset, entry.size, _size) ||
+            !validate_chunk(entry)) {
+            spdlog::error("asset chunk {} is malformed.", i);
+            return false;
+        }
+
+        if (validation == AssetValidation::Full &&
+            fnv1a64(_data + entry.offset, entry.size) != entry.checksum) {
+            spdlog::error("asset chunk {} checksum mismatch.", chunk_name(i));
+            return false;
+        }
+    }
+
+    // 片段要在同一文件的骨架上采样，关节数不能超过骨架，
+    // 否则按骨架大小准备的 pose 放不下。没有骨架的文件不检查。
+    uint32_t max_joints = 0;
+    bool has_skeleton = false;
+    for (unsigned int i = 0; i < header.num_chunks; ++i) {
+        const AssetChunk& entry = chunks()[i];
+        if (entry.type == static_cast<uint32_t>(AssetChunkType::Skeleton)) {
+            const auto* skeleton = reinterpret_cast<const SkeletonChunkHeader*>(
+                _data + entry.offset);
+            max_joints = std::max(max_joints, skeleton->num_joints);
+            has_skeleton = true;
+        }
+    }
+    for (unsigned int i = 0; has_skeleton && i < header.num_chunks; ++i) {
+        const AssetChunk& entry = chunks()[i];
+        if (entry.type == static_cast<uint32_t>(AssetChunkType::Clip) &&
+            reinterpret_cast<const CompressedClipHeader*>(_data + entry.offset)
+                    ->num_joints > max_joints) {
+            spdlog::error("clip {} has more joints than the skeleton.",
+                          chunk_name(i));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AssetFile::validate_chunk(const AssetChunk& chunk) const {
+    const uint8_t* data = _data + chunk.offset;
+    switch (static_cast<AssetChunkType>(chunk.type)) {
+        case AssetChunkType::Skeleton: {
+            if (chunk.size < sizeof(SkeletonChunkHeader)) {
+                return false;
+            }
+            const auto& h = *reinterpret_cast<const SkeletonChunkHeader*>(data);
+            uint64_t n = h.num_joints;
+            if (!in_range(h.parents_offset, n * sizeof(int32_t), chunk.size) ||
+                !in_range(h.rest_offset, n * sizeof(AssetTransform),
+                          chunk.size) ||
+                !in_range(h.bind_offset, n * sizeof(AssetTransform),
+                          chunk.size) ||
+                !in_range(h.name_offsets_offset, n * sizeof(uint32_t),
+                          chunk.size) ||
+                !in_range(h.names_offset, h.names_size, chunk.size) ||
+                (n > 0 && (h.names_size == 0 ||
+                           data[h.names_offset + h.names_size - 1] != 0))) {
+                return false;
+            }
+            const auto* parents =
+                reinterpret_cast<const int32_t*>(data + h.parents_offset);
+            const auto* names =
+                reinterpret_cast<const uint32_t*>(data + h.name_offsets_offset);
+            // 父关节必须排在前面，这样不会成环，计算全局变换时
+            // 按顺序一遍就能算完。
+            for (uint64_t i = 0; i < n; ++i) {
+                if (parents[i] < -1 || parents[i] >= static_cast<int64_t>(i) ||
+                    names[i] >= h.names_size) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case AssetChunkType::Clip: {
+            CompressedClip clip;
+            return clip.attach(data, chunk.size);
+        }
+        case AssetChunkType::SkinnedMesh: {
+            if (chunk.size < sizeof(SkinnedMeshChunkHeader)) {
+                return false;
+            }
+            const auto& h =
+                *reinterpret_cast<const SkinnedMeshChunkHeader*>(data);
+            uint64_t n = h.num_vertices;
+            auto stream_ok = [&](uint32_t offset, uint64_t bytes) {
+                return offset == 0 || in_range(offset, bytes, chunk.size);
+            };
+            if (!stream_ok(h.positions_offset, n * sizeof(float) * 3) ||
+                !stream_ok(h.normals_offset, n * sizeof(float) * 3) ||
+                !stream_ok(h.uvs_offset, n * sizeof(float) * 2) ||
+                !stream_ok(h.joints_offset, n * sizeof(uint16_t) * 4) ||
+                !stream_ok(h.weights_offset, n * sizeof(float) * 4) ||
+                !stream_ok(h.indices_offset,
+                           uint64_t{h.num_indices} * sizeof(uint32_t))) {
+                return false;
+            }
+            // 索引越界会让 GPU 读到缓冲区之外，这一项只在加载时查一次。
+            const uint32_t* indices =
+                h.indices_offset ? reinterpret_cast<const uint32_t*>(
+                                       data + h.indices_offset)
+                                 : nullptr;
+            for (uint32_t i = 0; indices && i < h.num_indices; ++i) {
+                if (indices[i] >= n) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    // 未知类型的块留给更新的版本，跳过即可。
+    return true;
+}
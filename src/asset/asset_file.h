@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../anim/compressed_clip.h"
+#include "../anim/skeleton.h"
+#include "../math/transform.h"
+#include "asset_format.h"
+#include "mapped_file.h"
+#include "skinned_mesh.h"
+
+enum class AssetValidation {
+    // 只校验文件头、块表和各块内部的偏移，开销与块数成正比。
+    Header,
+    // 额外计算每个块的校验和，需要读遍整个文件。
+    Full,
+};
+
+// 直接指向映射内存的骨架，文件关闭后失效。
+class SkeletonView {
+public:
+    SkeletonView() : _base{nullptr}, _header{nullptr} {}
+    explicit SkeletonView(const uint8_t* chunk)
+        : _base{chunk},
+          _header{reinterpret_cast<const SkeletonChunkHeader*>(chunk)} {}
+
+    bool empty() const { return _header == nullptr; }
+    unsigned int size() const { return _header ? _header->num_joints : 0; }
+
+    int parent(unsigned int index) const;
+    Transform rest_transform(unsigned int index) const;
+    Transform bind_transform(unsigned int index) const;
+    const char* joint_name(unsigned int index) const;
+
+    void to_skeleton(Skeleton& out) const;
+
+private:
+    const uint8_t* _base;
+    const SkeletonChunkHeader* _header;
+};
+
+// 顶点流直接指向映射内存，可以原样交给 glBufferData。
+class SkinnedMeshView {
+public:
+    SkinnedMeshView() : _base{nullptr}, _header{nullptr} {}
+    explicit SkinnedMeshView(const uint8_t* chunk)
+        : _base{chunk},
+          _header{reinterpret_cast<const SkinnedMeshChunkHeader*>(chunk)} {}
+
+    bool empty() const { return _header == nullptr; }
+    unsigned int num_vertices() const {
+        return _header ? _header->num_vertices : 0;
+    }
+    unsigned int num_indices() const {
+        return _header ? _header->num_indices : 0;
+    }
+
+    const float* positions() const {
+        return stream<float>(_header->positions_offset);
+    }
+    const float* normals() const {
+        return stream<float>(_header->normals_offset);
+    }
+    const float* uvs() const { return stream<float>(_header->uvs_offset); }
+    const uint16_t* joints() const {
+        return stream<uint16_t>(_header->joints_offset);
+    }
+    const float* weights() const {
+        return stream<float>(_header->weights_offset);
+    }
+    const uint32_t* indices() const {
+        return stream<uint32_t>(_header->indices_offset);
+    }
+
+private:
+    template <typename T>
+    const T* stream(uint32_t offset) const {
+        return offset ? reinterpret_cast<const T*>(_base + offset) : nullptr;
+    }
+
+    const uint8_t* _base;
+    const SkinnedMeshChunkHeader* _header;
+};
+
+class AssetWriter {
+public:
+    void add_skeleton(const std::string& name, const Skeleton& skeleton);
+    bool add_clip(const std::string& name, const CompressedClip& clip);
+    void add_mesh(const std::string& name, const SkinnedMeshData& mesh);
+
+    void build(std::vector<uint8_t>& out) const;
+    [[nodiscard]] bool write(const std::string& path) const;
+
+private:
+    struct Entry {
+        AssetChunkType type;
+        std::string name;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<Entry> _entries;
+};
+
+class AssetFile final {
+public:
+    AssetFile();
+    AssetFile(const AssetFile&) = delete;
+    AssetFile& operator=(const AssetFile&) = delete;
+
+    [[nodiscard]] bool open(const std::string& path,
+                            AssetValidation validation =
+                                AssetValidation::Header);
+    // 使用调用者提供的内存，调用者负责在 AssetFile 使用期间保持其有效。
+    [[nodiscard]] bool attach(const void* data, size_t size,
+                              AssetValidation validation =
+                                  AssetValidation::Header);
+    void close();
+
+    bool is_open() const { return _header != nullptr; }
+    unsigned int num_chunks() const {
+        return _header ? _header->num_chunks : 0;
+    }
+    const AssetChunk& chunk(unsigned int index) const {
+        return chunks()[index];
+    }
+    const char* chunk_name(unsigned int index) const;
+    const uint8_t* chunk_data(unsigned int index) const {
+        return _data + chunks()[index].offset;
+    }
+
+    // 没有找到时返回 -1。
+    int find(AssetChunkType type, const std::string& name) const;
+
+    bool clip(unsigned int index, CompressedClip& out) const;
+    SkeletonView skeleton(unsigned int index) const;
+    SkinnedMeshView mesh(unsigned int index) const;
+
+private:
+    const AssetChunk* chunks() const {
+        return reinterpret_cast<const AssetChunk*>(
+            _data + _header->chunk_table_offset);
+    }
+
+    bool validate(AssetValidation validation) const;
+    bool validate_chunk(const AssetChunk& chunk) const;
+
+    MappedFile _file;
+    const uint8_t* _data;
+    size_t _size;
+    const AssetFileHeader* _header;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+// 资源容器的磁盘布局。所有结构只含定长整数和浮点数，偏移都相对于文件开头，
+// 映射进内存后可以直接当作这些结构读取。按小端序写入。
+//
+//   AssetFileHeader
+//   AssetChunk[num_chunks]
+//   字符串表（以 0 结尾的名字首尾相接）
+//   各块数据，起始地址按 ASSET_ALIGNMENT 对齐
+constexpr uint32_t ASSET_MAGIC = 0x4d494e41; // "ANIM"
+constexpr uint32_t ASSET_VERSION = 1;
+constexpr uint32_t ASSET_ALIGNMENT = 64;
+
+enum class AssetChunkType : uint32_t {
+    Skeleton = 1,
+    Clip = 2,
+    SkinnedMesh = 3,
+};
+
+struct AssetFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t file_size;
+    uint32_t num_chunks;
+    uint32_t chunk_table_offset;
+    uint32_t string_table_offset;
+    uint32_t string_table_size;
+    // 覆盖文件头（此字段按 0 计算）、块表和字符串表，打开时总会校验。
+    uint64_t header_checksum;
+};
+
+struct AssetChunk {
+    uint32_t type;
+    uint32_t name_offset;
+    uint64_t offset;
+    uint64_t size;
+    // 块数据的校验和，只有完整校验时才计算。
+    uint64_t checksum;
+};
+
+struct AssetTransform {
+    float position[3];
+    float rotation[4];
+    float scale[3];
+};
+
+struct SkeletonChunkHeader {
+    uint32_t num_joints;
+    uint32_t parents_offset;      // int32_t[num_joints]
+    uint32_t rest_offset;         // AssetTransform[num_joints]
+    uint32_t bind_offset;         // AssetTransform[num_joints]
+    uint32_t name_offsets_offset; // uint32_t[num_joints]，相对名字区
+    uint32_t names_offset;
+    uint32_t names_size;
+    uint32_t reserved;
+};
+
+// 顶点流各自连续存放，偏移为 0 表示没有这条流。
+struct SkinnedMeshChunkHeader {
+    uint32_t num_vertices;
+    uint32_t num_indices;
+    uint32_t positions_offset; // float[3 * num_vertices]
+    uint32_t normals_offset;   // float[3 * num_vertices]
+    uint32_t uvs_offset;       // float[2 * num_vertices]
+    uint32_t joints_offset;    // uint16_t[4 * num_vertices]
+    uint32_t weights_offset;   // float[4 * num_vertices]
+    uint32_t indices_offset;   // uint32_t[num_indices]
+};
+
+static_assert(sizeof(AssetFileHeader) == 40, "asset header layout changed");
+static_assert(sizeof(AssetChunk) == 32, "asset chunk layout changed");
+static_assert(sizeof(AssetTransform) == 40, "asset transform layout changed");
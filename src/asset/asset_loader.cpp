@@ -0,0 +1,961 @@
+#include "asset_loader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include <spdlog/spdlog.h>
+
+#include "../core/log.h"
+#include "../core/profiler.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ANIM_HAS_IO_URING 1
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef ANIM_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+// 句柄的低 16 位是槽位。
+constexpr uint32_t MAX_REQUESTS = 1u << 16;
+constexpr uint32_t NO_RELOAD = ~0u;
+
+uint8_t* allocate_buffer(size_t size) {
+    return static_cast<uint8_t*>(
+        ::operator new(size, std::align_val_t{ASSET_ALIGNMENT}));
+}
+
+void free_buffer(uint8_t* data) {
+    ::operator delete(data, std::align_val_t{ASSET_ALIGNMENT});
+}
+
+} // namespace
+
+struct AssetLoader::Request {
+    std::string path;
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t read = 0;
+    AssetFile file;
+    bool ok = false;
+    // 从资源包加载时不为空。
+    const PackFile* pack = nullptr;
+    unsigned int entry = 0;
+
+    // 热重载用一个不对外的请求读取新数据，记下要替换的请求。
+    uint32_t reload_target = NO_RELOAD;
+    uint32_t reload_generation = 0;
+    // 以下只在持有 _mutex 时访问。
+    bool reloading = false;
+    bool reload_again = false;
+    bool watched = false;
+#ifdef _WIN32
+    std::FILE* stream = nullptr;
+#else
+    int fd = -1;
+    iovec iov = {};
+#endif
+
+    std::atomic<uint32_t> generation{1};
+    std::atomic<AssetLoadState> state{AssetLoadState::Invalid};
+    // 进行中的请求被释放时只打标记，完成后由 drain 回收。
+    std::atomic<bool> released{false};
+    // 完成队列中的下一个请求。
+    Request* next = nullptr;
+};
+
+#ifdef ANIM_HAS_IO_URING
+
+namespace {
+
+constexpr uint64_t WAKE_USER_DATA = ~uint64_t(0);
+
+int io_uring_setup(unsigned int entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                   unsigned int flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+} // namespace
+
+// 直接使用系统调用，不依赖 liburing。提交和收割都只在 I/O 线程上进行，
+// 与内核之间的同步只需要对头尾指针做 acquire/release。
+struct AssetLoader::IoUring {
+    int fd = -1;
+    int wake_fd = -1;
+
+    void* sq_ring = nullptr;
+    size_t sq_ring_size = 0;
+    void* cq_ring = nullptr;
+    size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+
+    unsigned int* sq_head = nullptr;
+    unsigned int* sq_tail = nullptr;
+    unsigned int* sq_array = nullptr;
+    unsigned int sq_mask = 0;
+    unsigned int sq_entries = 0;
+
+    unsigned int* cq_head = nullptr;
+    unsigned int* cq_tail = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned int cq_mask = 0;
+
+    ~IoUring() {
+        if (sqes) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (wake_fd >= 0) {
+            ::close(wake_fd);
+        }
+    }
+
+    bool init(unsigned int entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = io_uring_setup(entries, &params);
+        if (fd < 0) {
+            return false;
+        }
+
+        sq_ring_size = params.sq_off.array +
+                       params.sq_entries * sizeof(unsigned int);
+        cq_ring_size = params.cq_off.cqes +
+                       params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size =
+                std::max(sq_ring_size, cq_ring_size);
+        }
+
+        sq_ring = map(sq_ring_size, IORING_OFF_SQ_RING);
+        cq_ring = single_mmap ? sq_ring : map(cq_ring_size, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+        if (!sq_ring || !cq_ring || !sqes) {
+            return false;
+        }
+
+        uint8_t* sq = static_cast<uint8_t*>(sq_ring);
+        sq_head = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+        sq_array = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+        sq_mask =
+            *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+
+        uint8_t* cq = static_cast<uint8_t*>(cq_ring);
+        cq_head = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        cq_mask =
+            *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+
+        wake_fd = eventfd(0, EFD_CLOEXEC);
+        return wake_fd >= 0;
+    }
+
+    void* map(size_t size, off_t offset) const {
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, offset);
+        return data == MAP_FAILED ? nullptr : data;
+    }
+
+    // 队列满时返回空。调用者填好后必须调用 push。
+    io_uring_sqe* next_sqe() {
+        unsigned int tail = *sq_tail;
+        unsigned int head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head >= sq_entries) {
+            return nullptr;
+        }
+        io_uring_sqe* sqe = &sqes[tail & sq_mask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    void push() {
+        unsigned int tail = *sq_tail;
+        sq_array[tail & sq_mask] = tail & sq_mask;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // 等待 eventfd 可读，load 和 shutdown 写入它来唤醒阻塞在内核中的 I/O 线程。
+    bool arm_wake() {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = wake_fd;
+        sqe->poll_events = POLLIN;
+        sqe->user_data = WAKE_USER_DATA;
+        push();
+        return true;
+    }
+};
+
+#else
+
+struct AssetLoader::IoUring {};
+
+#endif
+
+AssetLoader::AssetLoader()
+    : _jobs{nullptr}, _capacity{0}, _stop{false}, _completed{nullptr} {}
+
+AssetLoader::~AssetLoader() { shutdown(); }
+
+bool AssetLoader::init(JobSystem* jobs, const AssetLoaderSettings& settings) {
+    if (_requests) {
+        return true;
+    }
+
+    _jobs = jobs;
+    _settings = settings;
+    _settings.queue_depth = std::max(_settings.queue_depth, 1u);
+    _settings.io_threads = std::max(_settings.io_threads, 1u);
+    _capacity = std::min(std::max(settings.max_requests, 1u), MAX_REQUESTS);
+    _requests = std::make_unique<Request[]>(_capacity);
+
+    // 倒序压入，先分配低位槽位。
+    _free.clear();
+    _free.reserve(_capacity);
+    for (uint32_t i = _capacity; i > 0; --i) {
+        _free.push_back(i - 1);
+    }
+    _pending.clear();
+    _stop = false;
+
+    if (_settings.hot_reload) {
+        _watcher = std::make_unique<AssetWatcher>();
+        if (!_watcher->init(&AssetLoader::file_changed, this)) {
+            _watcher.reset();
+        }
+    }
+
+#ifdef ANIM_HAS_IO_URING
+    if (_settings.use_io_uring) {
+        // 多留一项给唤醒用的 poll。
+        auto ring = std::make_unique<IoUring>();
+        if (ring->init(_settings.queue_depth + 1)) {
+            _uring = std::move(ring);
+        } else {
+            spdlog::warn("io_uring unavailable ({}), using blocking reads.",
+                         std::strerror(errno));
+        }
+    }
+    if (_uring) {
+        _threads.emplace_back(&AssetLoader::uring_main, this);
+        spdlog::info("asset loader started with io_uring, queue depth {}.",
+                     _settings.queue_depth);
+        return true;
+    }
+#endif
+
+    for (unsigned int i = 0; i < _settings.io_threads; ++i) {
+        _threads.emplace_back(&AssetLoader::pool_main, this);
+    }
+    spdlog::info("asset loader started with {} blocking I/O threads.",
+                 _settings.io_threads);
+    return true;
+}
+
+void AssetLoader::shutdown() {
+    if (!_requests) {
+        return;
+    }
+
+    // 先停掉监视线程，之后不会再有新的重载请求。
+    if (_watcher) {
+        _watcher->shutdown();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _pending_cv.notify_all();
+    wake_io();
+
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+    if (_jobs) {
+        _jobs->wait(_decode_counter);
+    }
+
+    // I/O 线程已经退出，剩下的请求不会再被访问。
+    _completed.store(nullptr, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < _capacity; ++i) {
+        Request& request = _requests[i];
+        request.file.close();
+        if (request.data) {
+            free_buffer(request.data);
+        }
+    }
+    _requests.reset();
+    _capacity = 0;
+    _free.clear();
+    _pending.clear();
+    _uring.reset();
+    _watcher.reset();
+}
+
+AssetLoadHandle AssetLoader::load(const std::string& path) {
+    AssetLoadHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Request* request = allocate_request(path);
+        if (!request) {
+            return handle;
+        }
+
+        request->state.store(AssetLoadState::Queued,
+                             std::memory_order_release);
+        _pending.push_back(index_of(*request));
+        handle = handle_of(*request);
+    }
+
+    wake_io();
+    return handle;
+}
+
+AssetLoadHandle AssetLoader::load(const PackFile& pack,
+                                  const std::string& name) {
+    int entry = pack.find(name);
+    if (entry < 0) {
+        spdlog::error("asset not found in pack: {}", name);
+        return AssetLoadHandle();
+    }
+
+    Request* request = nullptr;
+    AssetLoadHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        request = allocate_request(name);
+        if (!request) {
+            return handle;
+        }
+
+        request->pack = &pack;
+        request->entry = static_cast<unsigned int>(entry);
+        request->state.store(AssetLoadState::Decoding,
+                             std::memory_order_release);
+        handle = handle_of(*request);
+    }
+
+    dispatch_decode(*request);
+    return handle;
+}
+
+AssetLoadState AssetLoader::state(AssetLoadHandle handle) const {
+    Request* request = get(handle);
+    if (!request) {
+        return AssetLoadState::Invalid;
+    }
+
+    // 读取状态后再核对一次代数，槽位在两次读取之间被复用时视为无效。
+    AssetLoadState state = request->state.load(std::memory_order_acquire);
+    if (request->generation.load(std::memory_order_acquire) !=
+        handle.value >> 16) {
+        return AssetLoadState::Invalid;
+    }
+    return state;
+}
+
+const AssetFile* AssetLoader::file(AssetLoadHandle handle) const {
+    Request* request = get(handle);
+    if (!request || request->state.load(std::memory_order_acquire) !=
+                        AssetLoadState::Ready) {
+        return nullptr;
+    }
+    return &request->file;
+}
+
+void AssetLoader::release(AssetLoadHandle handle) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Request* request = get(handle);
+    if (!request) {
+        return;
+    }
+
+    AssetLoadState state = request->state.load(std::memory_order_acquire);
+    if (state == AssetLoadState::Ready || state == AssetLoadState::Failed) {
+        free_request(*request);
+    } else {
+        request->released.store(true, std::memory_order_release);
+    }
+}
+
+unsigned int AssetLoader::drain(AssetLoadCallback callback, void* user) {
+    Request* list = _completed.exchange(nullptr, std::memory_order_acquire);
+    if (!list) {
+        return 0;
+    }
+
+    // 栈里是后完成的在前，翻转成完成顺序。
+    Request* ordered = nullptr;
+    while (list) {
+        Request* next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+
+    // 在锁内发布状态、替换重载的数据并回收已释放的请求，
+    // 回调放到锁外，回调里可以继续提交请求。
+    Request* head = nullptr;
+    Request** tail = &head;
+    Request* retired = nullptr;
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        while (ordered) {
+            Request* request = ordered;
+            ordered = request->next;
+
+            Request* publish = request;
+            if (request->reload_target != NO_RELOAD) {
+                // 可能又排了一次重载，多唤醒一次 I/O 线程也无妨。
+                wake = true;
+                publish = apply_reload(*request);
+                if (!publish) {
+                    free_request(*request);
+                    continue;
+                }
+                // 换下来的旧数据留到回调之后再释放。
+                request->next = retired;
+                retired = request;
+            } else if (request->released.load(std::memory_order_acquire)) {
+                free_request(*request);
+                continue;
+            } else {
+                request->state.store(request->ok ? AssetLoadState::Ready
+                                                 : AssetLoadState::Failed,
+                                     std::memory_order_release);
+                if (request->ok && !request->pack && _watcher) {
+                    _watcher->watch(request->path);
+                    request->watched = true;
+                }
+            }
+
+            publish->next = nullptr;
+            *tail = publish;
+            tail = &publish->next;
+        }
+    }
+    if (wake) {
+        wake_io();
+    }
+
+    unsigned int count = 0;
+    for (Request* request = head; request;) {
+        Request* next = request->next;
+        callback(user, handle_of(*request),
+                 request->ok ? &request->file : nullptr);
+        request = next;
+        ++count;
+    }
+
+    if (retired) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        while (retired) {
+            Request* next = retired->next;
+            free_request(*retired);
+            retired = next;
+        }
+    }
+    return count;
+}
+
+AssetLoader::Request* AssetLoader::get(AssetLoadHandle handle) const {
+    uint32_t index = handle.value & 0xffff;
+    if (!handle.valid() || index >= _capacity) {
+        return nullptr;
+    }
+
+    Request* request = &_requests[index];
+    if (request->generation.load(std::memory_order_acquire) !=
+        handle.value >> 16) {
+        return nullptr;
+    }
+    return request;
+}
+
+uint32_t AssetLoader::index_of(const Request& request) const {
+    return static_cast<uint32_t>(&request - _requests.get());
+}
+
+AssetLoadHandle AssetLoader::handle_of(const Request& request) const {
+    uint32_t generation = request.generation.load(std::memory_order_relaxed);
+    return AssetLoadHandle{generation << 16 | index_of(request)};
+}
+
+AssetLoader::Request* AssetLoader::allocate_request(const std::string& path) {
+    if (!_requests || _stop) {
+        return nullptr;
+    }
+    if (_free.empty()) {
+        ANIM_LOG_RATE_LIMITED(spdlog::level::warn, 1000,
+                              "too many asset requests, dropping {}.", path);
+        return nullptr;
+    }
+
+    Request& request = _requests[_free.back()];
+    _free.pop_back();
+    request.path = path;
+    request.ok = false;
+    request.reload_target = NO_RELOAD;
+    request.reloading = false;
+    request.reload_again = false;
+    request.released.store(false, std::memory_order_relaxed);
+    return &request;
+}
+
+void AssetLoader::wake_io() {
+#ifdef ANIM_HAS_IO_URING
+    if (_uring) {
+        uint64_t one = 1;
+        if (::write(_uring->wake_fd, &one, sizeof(one)) < 0) {
+            spdlog::error("wake asset I/O thread failed: {}",
+                          std::strerror(errno));
+        }
+        return;
+    }
+#endif
+    _pending_cv.notify_one();
+}
+
+#ifdef _WIN32
+
+bool AssetLoader::begin_read(Request& request) {
+    request.state.store(AssetLoadState::Reading, std::memory_order_relaxed);
+    if (request.released.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    request.stream = std::fopen(request.path.c_str(), "rb");
+    if (!request.stream) {
+        spdlog::error("open file failed: {}", request.path);
+        return false;
+    }
+
+    long long size = -1;
+    if (_fseeki64(request.stream, 0, SEEK_END) == 0) {
+        size = _ftelli64(request.stream);
+    }
+    if (size <= 0 || _fseeki64(request.stream, 0, SEEK_SET) != 0) {
+        spdlog::error("empty or unreadable file: {}", request.path);
+        return false;
+    }
+
+    request.size = static_cast<size_t>(size);
+    request.read = 0;
+    request.data = allocate_buffer(request.size);
+    return true;
+}
+
+bool AssetLoader::read_blocking(Request& request) {
+    request.read = std::fread(request.data, 1, request.size, request.stream);
+    if (request.read != request.size) {
+        spdlog::error("read file failed: {}", request.path);
+        return false;
+    }
+    return true;
+}
+
+#else
+
+bool AssetLoader::begin_read(Request& request) {
+    request.state.store(AssetLoadState::Reading, std::memory_order_relaxed);
+    if (request.released.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    request.fd = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (request.fd < 0) {
+        spdlog::error("open file failed: {}", request.path);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(request.fd, &info) != 0 || info.st_size <= 0) {
+        spdlog::error("empty or unreadable file: {}", request.path);
+        return false;
+    }
+
+    request.size = static_cast<size_t>(info.st_size);
+    request.read = 0;
+    request.data = allocate_buffer(request.size);
+    return true;
+}
+
+bool AssetLoader::read_blocking(Request& request) {
+    while (request.read < request.size) {
+        ssize_t result =
+            ::pread(request.fd, request.data + request.read,
+                    request.size - request.read,
+                    static_cast<off_t>(request.read));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            spdlog::error("read file failed: {}", request.path);
+            return false;
+        }
+        request.read += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+#endif
+
+void AssetLoader::end_read(Request& request, bool ok) {
+#ifdef _WIN32
+    if (request.stream) {
+        std::fclose(request.stream);
+        request.stream = nullptr;
+    }
+#else
+    if (request.fd >= 0) {
+        ::close(request.fd);
+        request.fd = -1;
+    }
+#endif
+
+    if (!ok) {
+        if (request.data) {
+            free_buffer(request.data);
+            request.data = nullptr;
+        }
+        request.ok = false;
+        complete(request);
+        return;
+    }
+
+    request.state.store(AssetLoadState::Decoding, std::memory_order_relaxed);
+    dispatch_decode(request);
+}
+
+void AssetLoader::dispatch_decode(Request& request) {
+    if (!_jobs) {
+        decode(request);
+        return;
+    }
+
+    // 解压和完整校验可能很慢，走后台队列，帧内的 wait 不会顺手执行它。
+    uint32_t index = index_of(request);
+    _jobs->run_background(Job{&AssetLoader::decode_job, this, index,
+                              index + 1, &_decode_counter, nullptr});
+}
+
+void AssetLoader::decode_job(void* data, uint32_t begin, uint32_t) {
+    AssetLoader* loader = static_cast<AssetLoader*>(data);
+    loader->decode(loader->_requests[begin]);
+}
+
+void AssetLoader::decode(Request& request) {
+    ANIM_PROFILE_SCOPE("AssetDecode");
+    if (request.released.load(std::memory_order_acquire)) {
+        request.ok = false;
+        complete(request);
+        return;
+    }
+
+    // 块内都是相对偏移，内存对齐后校验一遍即可原地使用。
+    // 单独的文件没有别的校验，要完整校验；包里的条目解压时已经核对过校验和，
+    // 原地使用的条目只校验结构，页面留给系统按需载入。
+    const uint8_t* data = request.data;
+    AssetValidation validation = AssetValidation::Full;
+    if (request.pack) {
+        const PackEntry& entry = request.pack->entry(request.entry);
+        request.size = static_cast<size_t>(entry.size);
+        data = request.pack->data(request.entry);
+        if (!data && entry.size > 0) {
+            request.data = allocate_buffer(request.size);
+            data = request.pack->extract(request.entry, request.data)
+                       ? request.data
+                       : nullptr;
+        }
+        validation = AssetValidation::Header;
+    }
+
+    request.ok = data && request.file.attach(data, request.size, validation);
+    if (!request.ok) {
+        spdlog::error("invalid asset file: {}", request.path);
+    }
+    complete(request);
+}
+
+void AssetLoader::complete(Request& request) {
+    request.state.store(AssetLoadState::Completed, std::memory_order_release);
+
+    Request* head = _completed.load(std::memory_order_relaxed);
+    do {
+        request.next = head;
+    } while (!_completed.compare_exchange_weak(head, &request,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+void AssetLoader::free_request(Request& request) {
+    if (request.watched) {
+        _watcher->unwatch(request.path);
+        request.watched = false;
+    }
+    request.file.close();
+    if (request.data) {
+        free_buffer(request.data);
+        request.data = nullptr;
+    }
+    request.size = 0;
+    request.read = 0;
+    request.pack = nullptr;
+    request.path.clear();
+    request.state.store(AssetLoadState::Invalid, std::memory_order_relaxed);
+
+    // 代数只占 16 位，跳过 0 保证句柄不会为 0。
+    uint32_t generation =
+        (request.generation.load(std::memory_order_relaxed) + 1) & 0xffff;
+    request.generation.store(generation ? generation : 1,
+                             std::memory_order_release);
+    _free.push_back(index_of(request));
+}
+
+void AssetLoader::file_changed(void* user, const std::string& path) {
+    auto* loader = static_cast<AssetLoader*>(user);
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(loader->_mutex);
+        for (uint32_t i = 0; i < loader->_capacity; ++i) {
+            Request& request = loader->_requests[i];
+            if (request.watched && request.path == path &&
+                request.state.load(std::memory_order_relaxed) ==
+                    AssetLoadState::Ready) {
+                queued = loader->queue_reload(request) || queued;
+            }
+        }
+    }
+
+    if (queued) {
+        spdlog::info("reloading asset: {}", path);
+        loader->wake_io();
+    }
+}
+
+bool AssetLoader::queue_reload(Request& target) {
+    // 重载进行中又有变化时，等这次完成后再读一遍。
+    if (target.reloading) {
+        target.reload_again = true;
+        return false;
+    }
+
+    Request* shadow = allocate_request(target.path);
+    if (!shadow) {
+        return false;
+    }
+    shadow->reload_target = index_of(target);
+    shadow->reload_generation =
+        target.generation.load(std::memory_order_relaxed);
+    shadow->state.store(AssetLoadState::Queued, std::memory_order_release);
+    target.reloading = true;
+    _pending.push_back(index_of(*shadow));
+    return true;
+}
+
+AssetLoader::Request* AssetLoader::apply_reload(Request& shadow) {
+    // 读取期间原请求可能已经释放，槽位甚至已经被复用。
+    Request& target = _requests[shadow.reload_target];
+    if (target.generation.load(std::memory_order_relaxed) !=
+        shadow.reload_generation) {
+        return nullptr;
+    }
+    target.reloading = false;
+    if (target.reload_again) {
+        target.reload_again = false;
+        queue_reload(target);
+    }
+    if (!shadow.ok) {
+        spdlog::warn("reload failed, keeping the previous version: {}",
+                     target.path);
+        return nullptr;
+    }
+
+    // 新数据已经完整校验过，这里只是把视图换过去。句柄和 AssetFile 的地址不变，
+    // 场景持有的播放进度等状态不受影响。
+    std::swap(target.data, shadow.data);
+    std::swap(target.size, shadow.size);
+    shadow.file.close();
+    target.ok = target.file.attach(target.data, target.size,
+                                   AssetValidation::Header);
+    target.state.store(target.ok ? AssetLoadState::Ready
+                                 : AssetLoadState::Failed,
+                       std::memory_order_release);
+    return &target;
+}
+
+void AssetLoader::pool_main() {
+    Profiler::set_thread_name("asset io");
+
+    for (;;) {
+        uint32_t index = 0;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _pending_cv.wait(lock,
+                             [this] { return _stop || !_pending.empty(); });
+            if (_stop) {
+                return;
+            }
+            index = _pending.front();
+            _pending.pop_front();
+        }
+
+        Request& request = _requests[index];
+        bool ok = begin_read(request) && read_blocking(request);
+        end_read(request, ok);
+    }
+}
+
+#ifdef ANIM_HAS_IO_URING
+
+bool AssetLoader::submit_read(Request& request) {
+    io_uring_sqe* sqe = _uring->next_sqe();
+    if (!sqe) {
+        return false;
+    }
+
+    request.iov.iov_base = request.data + request.read;
+    request.iov.iov_len = request.size - request.read;
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = request.fd;
+    sqe->off = request.read;
+    sqe->addr = reinterpret_cast<uint64_t>(&request.iov);
+    sqe->len = 1;
+    sqe->user_data = index_of(request);
+    _uring->push();
+    return true;
+}
+
+void AssetLoader::uring_main() {
+    Profiler::set_thread_name("asset io");
+
+    IoUring& ring = *_uring;
+    std::deque<uint32_t> backlog;
+    unsigned int in_flight = 0;
+    unsigned int to_submit = ring.arm_wake() ? 1 : 0;
+    bool stop = false;
+
+    for (;;) {
+        if (!stop) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            stop = _stop;
+            backlog.insert(backlog.end(), _pending.begin(), _pending.end());
+            _pending.clear();
+        }
+
+        // 超出队列深度的请求等读操作完成后再提交，提交队列总为唤醒留有位置。
+        while (!stop && !backlog.empty() &&
+               in_flight < _settings.queue_depth) {
+            Request& request = _requests[backlog.front()];
+            backlog.pop_front();
+            if (!begin_read(request)) {
+                end_read(request, false);
+                continue;
+            }
+            if (!submit_read(request)) {
+                end_read(request, read_blocking(request));
+                continue;
+            }
+            ++in_flight;
+            ++to_submit;
+        }
+
+        if (stop && in_flight == 0) {
+            return;
+        }
+
+        int submitted = io_uring_enter(ring.fd, to_submit, 1,
+                                       IORING_ENTER_GETEVENTS);
+        if (submitted < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                spdlog::error("io_uring_enter failed: {}",
+                              std::strerror(errno));
+                return;
+            }
+        } else {
+            to_submit -= std::min(to_submit,
+                                  static_cast<unsigned int>(submitted));
+        }
+
+        unsigned int head = *ring.cq_head;
+        unsigned int tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            io_uring_cqe cqe = ring.cqes[head & ring.cq_mask];
+            if (cqe.user_data == WAKE_USER_DATA) {
+                uint64_t count = 0;
+                if (::read(ring.wake_fd, &count, sizeof(count)) < 0 &&
+                    errno != EAGAIN) {
+                    spdlog::error("read asset wake event failed: {}",
+                                  std::strerror(errno));
+                }
+                to_submit += ring.arm_wake() ? 1 : 0;
+                continue;
+            }
+
+            Request& request = _requests[cqe.user_data];
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                to_submit += submit_read(request) ? 1 : 0;
+                continue;
+            }
+            if (cqe.res <= 0) {
+                spdlog::error("read file failed: {} ({})", request.path,
+                              std::strerror(cqe.res < 0 ? -cqe.res : EIO));
+                --in_flight;
+                end_read(request, false);
+                continue;
+            }
+
+            // 一次读不完时从已读到的位置继续提交。
+            request.read += static_cast<size_t>(cqe.res);
+            if (request.read < request.size) {
+                to_submit += submit_read(request) ? 1 : 0;
+                continue;
+            }
+            --in_flight;
+            end_read(request, true);
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+#endif
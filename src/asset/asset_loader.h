@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../core/job_system.h"
+#include "asset_file.h"
+#include "asset_watcher.h"
+#include "pack_file.h"
+
+struct AssetLoadHandle {
+    // 低 16 位是槽位，高 16 位是代数，0 表示无效。
+    uint32_t value = 0;
+
+    bool valid() const { return value != 0; }
+    bool operator==(AssetLoadHandle other) const {
+        return value == other.value;
+    }
+    bool operator!=(AssetLoadHandle other) const {
+        return value != other.value;
+    }
+};
+
+enum class AssetLoadState : uint8_t {
+    Invalid,
+    Queued,
+    Reading,
+    Decoding,
+    // 已经解码，等待帧边界发布。
+    Completed,
+    Ready,
+    Failed,
+};
+
+struct AssetLoaderSettings {
+    // 同时存在的请求数上限，包括已经加载完但还没释放的。
+    unsigned int max_requests = 1024;
+    // io_uring 中同时进行的读操作数。
+    unsigned int queue_depth = 64;
+    // 不支持 io_uring 时用于阻塞读取的线程数。
+    unsigned int io_threads = 2;
+    bool use_io_uring = true;
+    // 监视已加载的文件，变化后在后台重新读取，drain 时原地替换。
+    // 资源包中的条目不参与。
+    bool hot_reload = false;
+};
+
+using AssetLoadCallback = void (*)(void* user, AssetLoadHandle handle,
+                                   const AssetFile* file);
+
+// 后台读取资源文件：读取在 I/O 线程上进行（Linux 上优先用 io_uring，
+// 否则是阻塞读取的线程池），解压和校验交给任务系统的后台队列，
+// 完成的请求进入无锁队列，由主线程每帧 drain 一次统一发布。
+class AssetLoader final {
+public:
+    AssetLoader();
+    ~AssetLoader();
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader(AssetLoader&&) = delete;
+
+    AssetLoader& operator=(const AssetLoader&) = delete;
+    AssetLoader& operator=(AssetLoader&&) = delete;
+
+    // jobs 为空时收尾工作直接在 I/O 线程完成。
+    [[nodiscard]] bool init(JobSystem* jobs,
+                            const AssetLoaderSettings& settings);
+    // 等待进行中的读取和解码结束，尚未开始或尚未发布的请求直接丢弃。
+    void shutdown();
+
+    bool using_io_uring() const { return _uring != nullptr; }
+
+    // 以下接口线程安全。请求数达到上限时返回无效句柄。
+    AssetLoadHandle load(const std::string& path);
+    // 从资源包中加载，不经过 I/O 线程，解压直接在任务系统上进行。
+    // 未压缩的条目原地使用包的映射内存，pack 必须比句柄活得久。
+    AssetLoadHandle load(const PackFile& pack, const std::string& name);
+    AssetLoadState state(AssetLoadHandle handle) const;
+    // 只有 Ready 状态的请求返回非空，指针在 release 之前有效。
+    const AssetFile* file(AssetLoadHandle handle) const;
+    // 进行中的请求在完成后直接回收，不会再被发布。
+    void release(AssetLoadHandle handle);
+
+    // 只能在主线程调用，callback 对每个完成的请求调用一次，失败时 file 为空。
+    // 热重载完成时同一个句柄会再次回调，file 指针不变但内容已换成新数据，
+    // 旧数据在 callback 返回后释放，从中取得的视图要在回调里重新获取。
+    // 不要在 callback 执行的同时从其他线程 release 正在发布的句柄。
+    unsigned int drain(AssetLoadCallback callback, void* user);
+
+private:
+    struct Request;
+    struct IoUring;
+
+    Request* get(AssetLoadHandle handle) const;
+    uint32_t index_of(const Request& request) const;
+    AssetLoadHandle handle_of(const Request& request) const;
+    Request* allocate_request(const std::string& path);
+
+    void wake_io();
+
+    bool begin_read(Request& request);
+    bool read_blocking(Request& request);
+    void end_read(Request& request, bool ok);
+    void dispatch_decode(Request& request);
+    static void decode_job(void* data, uint32_t begin, uint32_t end);
+    void decode(Request& request);
+    void complete(Request& request);
+    void free_request(Request& request);
+
+    static void file_changed(void* user, const std::string& path);
+    bool queue_reload(Request& target);
+    Request* apply_reload(Request& shadow);
+
+    void pool_main();
+    void uring_main();
+    bool submit_read(Request& request);
+
+    JobSystem* _jobs;
+    AssetLoaderSettings _settings;
+
+    std::unique_ptr<Request[]> _requests;
+    uint32_t _capacity;
+
+    // 保护空闲槽位和待读取的请求，只在提交和回收时使用，不在每帧的热路径上。
+    std::mutex _mutex;
+    std::condition_variable _pending_cv;
+    std::vector<uint32_t> _free;
+    std::deque<uint32_t> _pending;
+    bool _stop;
+
+    // 完成的请求以侵入式链表压栈，drain 一次性取走整条链。
+    std::atomic<Request*> _completed;
+    JobCounter _decode_counter;
+
+    std::unique_ptr<AssetWatcher> _watcher;
+    std::unique_ptr<IoUring> _uring;
+    std::vector<std::thread> _threads;
+};
@@ -0,0 +1,256 @@
+#include "asset_registry.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// 句柄的低 16 位是槽位。
+constexpr uint32_t MAX_ASSETS = 1u << 16;
+
+} // namespace
+
+AssetRegistry::AssetRegistry() : _loader{nullptr}, _stamp{0} {}
+
+AssetRegistry::~AssetRegistry() { shutdown(); }
+
+bool AssetRegistry::init(AssetLoader* loader,
+                         const AssetRegistrySettings& settings) {
+    if (_loader) {
+        return true;
+    }
+    if (!loader) {
+        spdlog::error("asset registry needs an asset loader.");
+        return false;
+    }
+
+    _loader = loader;
+    init_pool(_skeletons, settings.max_skeletons);
+    init_pool(_clips, settings.max_clips);
+    init_pool(_meshes, settings.max_meshes);
+    _stamp = 0;
+    return true;
+}
+
+void AssetRegistry::shutdown() {
+    if (!_loader) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& file : _files) {
+        _loader->release(AssetLoadHandle{file.first});
+    }
+    _files.clear();
+    _paths.clear();
+    _released.clear();
+    clear_pool(_skeletons);
+    clear_pool(_clips);
+    clear_pool(_meshes);
+    _loader = nullptr;
+}
+
+AssetLoadHandle AssetRegistry::load(const std::string& path) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_loader) {
+        return AssetLoadHandle();
+    }
+
+    auto it = _paths.find(path);
+    if (it != _paths.end()) {
+        ++_files[it->second].count;
+        return AssetLoadHandle{it->second};
+    }
+
+    // 持有锁提交，保证 publish 时文件表里已经有这条记录。
+    AssetLoadHandle handle = _loader->load(path);
+    if (!handle.valid()) {
+        return handle;
+    }
+    File& file = _files[handle.value];
+    file.path = path;
+    file.count = 1;
+    _paths.emplace(path, handle.value);
+    return handle;
+}
+
+void AssetRegistry::release(AssetLoadHandle file) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _files.find(file.value);
+    if (it == _files.end() || it->second.count == 0) {
+        return;
+    }
+    if (--it->second.count == 0) {
+        _released.push_back(file.value);
+    }
+}
+
+void AssetRegistry::publish(AssetLoadHandle file, const AssetFile* data) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _files.find(file.value);
+    if (it == _files.end()) {
+        return;
+    }
+    File& record = it->second;
+
+    // 编号 0 留给空闲槽位。
+    if (++_stamp == 0) {
+        _stamp = 1;
+    }
+    std::vector<uint32_t> skeletons;
+    std::vector<uint32_t> clips;
+    std::vector<uint32_t> meshes;
+    unsigned int num_chunks = data ? data->num_chunks() : 0;
+    for (unsigned int i = 0; i < num_chunks; ++i) {
+        std::string name = data->chunk_name(i);
+        uint32_t index = 0;
+        switch (static_cast<AssetChunkType>(data->chunk(i).type)) {
+            case AssetChunkType::Skeleton:
+                if (bind(_skeletons, name, file.value, skeletons, index)) {
+                    data->skeleton(i).to_skeleton(_skeletons.items[index]);
+                }
+                break;
+            case AssetChunkType::Clip: {
+                // 直接指向文件内存，不拷贝采样数据。
+                CompressedClip clip;
+                if (!data->clip(i, clip)) {
+                    spdlog::error("invalid clip {} in {}", name, record.path);
+                    break;
+                }
+                if (bind(_clips, name, file.value, clips, index)) {
+                    _clips.items[index] = std::move(clip);
+                }
+                break;
+            }
+            case AssetChunkType::SkinnedMesh:
+                if (bind(_meshes, name, file.value, meshes, index)) {
+                    _meshes.items[index] = data->mesh(i);
+                }
+                break;
+        }
+    }
+
+    // 重载后不再存在的块直接移除，加载失败时移除全部。
+    remove_stale(_skeletons, record.skeletons);
+    remove_stale(_clips, record.clips);
+    remove_stale(_meshes, record.meshes);
+    record.skeletons = std::move(skeletons);
+    record.clips = std::move(clips);
+    record.meshes = std::move(meshes);
+}
+
+void AssetRegistry::collect() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (uint32_t value : _released) {
+        auto it = _files.find(value);
+        // 归零之后又被 load 过的文件继续保留。
+        if (it == _files.end() || it->second.count > 0) {
+            continue;
+        }
+
+        const File& file = it->second;
+        for (uint32_t index : file.skeletons) {
+            remove(_skeletons, index);
+        }
+        for (uint32_t index : file.clips) {
+            remove(_clips, index);
+        }
+        for (uint32_t index : file.meshes) {
+            remove(_meshes, index);
+        }
+        _paths.erase(file.path);
+        _loader->release(AssetLoadHandle{value});
+        _files.erase(it);
+    }
+    _released.clear();
+}
+
+template <typename T>
+void AssetRegistry::init_pool(Pool<T>& pool, unsigned int capacity) {
+    pool.capacity = std::min(std::max(capacity, 1u), MAX_ASSETS);
+    pool.items = std::make_unique<T[]>(pool.capacity);
+    pool.handles = std::make_unique<std::atomic<uint32_t>[]>(pool.capacity);
+    pool.slots = std::make_unique<Slot[]>(pool.capacity);
+
+    // 倒序压入，先分配低位槽位，资源尽量挤在数组前部。
+    pool.free.clear();
+    pool.free.reserve(pool.capacity);
+    for (uint32_t i = pool.capacity; i > 0; --i) {
+        pool.free.push_back(i - 1);
+    }
+    pool.names.clear();
+}
+
+template <typename T>
+void AssetRegistry::clear_pool(Pool<T>& pool) {
+    pool.items.reset();
+    pool.handles.reset();
+    pool.slots.reset();
+    pool.free.clear();
+    pool.names.clear();
+    pool.capacity = 0;
+}
+
+template <typename T>
+bool AssetRegistry::bind(Pool<T>& pool, const std::string& name,
+                         uint32_t owner, std::vector<uint32_t>& bound,
+                         uint32_t& index) {
+    auto it = pool.names.find(name);
+    if (it != pool.names.end()) {
+        // 同名的资源只保留先登记的那个，同一文件重载时原地更新。
+        const Slot& slot = pool.slots[it->second];
+        if (slot.owner != owner || slot.stamp == _stamp) {
+            spdlog::warn("duplicate asset name, ignoring: {}", name);
+            return false;
+        }
+        index = it->second;
+    } else {
+        if (pool.free.empty()) {
+            spdlog::error("too many assets, dropping {}.", name);
+            return false;
+        }
+        index = pool.free.back();
+        pool.free.pop_back();
+
+        Slot& slot = pool.slots[index];
+        slot.name = name;
+        slot.owner = owner;
+        // 代数跳过 0，句柄不会为 0。
+        slot.generation = (slot.generation + 1) & 0xffff;
+        if (slot.generation == 0) {
+            slot.generation = 1;
+        }
+        pool.names.emplace(name, index);
+        pool.handles[index].store(slot.generation << 16 | index,
+                                  std::memory_order_release);
+    }
+
+    pool.slots[index].stamp = _stamp;
+    bound.push_back(index);
+    return true;
+}
+
+template <typename T>
+void AssetRegistry::remove_stale(Pool<T>& pool,
+                                 const std::vector<uint32_t>& bound) {
+    for (uint32_t index : bound) {
+        if (pool.slots[index].stamp != _stamp) {
+            remove(pool, index);
+        }
+    }
+}
+
+template <typename T>
+void AssetRegistry::remove(Pool<T>& pool, uint32_t index) {
+    // 先让句柄失效，旧句柄之后查不到，槽位复用后代数也不同。
+    pool.handles[index].store(0, std::memory_order_release);
+    pool.items[index] = T();
+
+    Slot& slot = pool.slots[index];
+    pool.names.erase(slot.name);
+    slot.name.clear();
+    slot.owner = 0;
+    slot.stamp = 0;
+    pool.free.push_back(index);
+}
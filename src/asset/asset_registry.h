@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../anim/compressed_clip.h"
+#include "../anim/skeleton.h"
+#include "asset_file.h"
+#include "asset_loader.h"
+
+// 低 16 位是槽位，高 16 位是代数，0 表示无效。
+// T 只用来区分资源类型，不同类型的句柄不能混用。
+template <typename T>
+struct AssetHandle {
+    uint32_t value = 0;
+
+    bool valid() const { return value != 0; }
+    bool operator==(AssetHandle other) const { return value == other.value; }
+    bool operator!=(AssetHandle other) const { return value != other.value; }
+};
+
+using SkeletonHandle = AssetHandle<Skeleton>;
+using ClipHandle = AssetHandle<CompressedClip>;
+using MeshHandle = AssetHandle<SkinnedMeshView>;
+
+struct AssetRegistrySettings {
+    // 每种资源同时登记的数量上限，最多 65536。
+    unsigned int max_skeletons = 256;
+    unsigned int max_clips = 4096;
+    unsigned int max_meshes = 256;
+};
+
+// 按类型集中存放已加载的骨架、动画片段和网格，场景和任务只持有 32 位句柄。
+// 增删只发生在帧边界，帧内存储是只读的，所以按句柄读取不加锁，
+// 也不需要像 shared_ptr 那样在每次使用时增减原子计数。
+// 引用计数只在文件一级，由 load / release 维护。
+class AssetRegistry final {
+public:
+    AssetRegistry();
+    ~AssetRegistry();
+    AssetRegistry(const AssetRegistry&) = delete;
+    AssetRegistry(AssetRegistry&&) = delete;
+
+    AssetRegistry& operator=(const AssetRegistry&) = delete;
+    AssetRegistry& operator=(AssetRegistry&&) = delete;
+
+    [[nodiscard]] bool init(AssetLoader* loader,
+                            const AssetRegistrySettings& settings);
+    // 释放全部资源和加载请求，要在 loader 关闭之前调用。
+    void shutdown();
+
+    // 线程安全。同一路径共用一次加载，每次 load 都要配对一次 release。
+    AssetLoadHandle load(const std::string& path);
+    // 最后一次 release 后，文件中的资源在下一次 collect 时才销毁，
+    // 本帧内已经取得的句柄和指针仍然可用。
+    void release(AssetLoadHandle file);
+
+    // 按句柄读取可以在任意线程调用，不加锁。句柄失效时返回空，
+    // 返回的指针在下一个帧边界之前有效，不要跨帧保存。
+    const Skeleton* skeleton(SkeletonHandle handle) const {
+        return _skeletons.get(handle);
+    }
+    const CompressedClip* clip(ClipHandle handle) const {
+        return _clips.get(handle);
+    }
+    const SkinnedMeshView* mesh(MeshHandle handle) const {
+        return _meshes.get(handle);
+    }
+    // 按块名查找，没有找到时返回无效句柄。名字表在帧边界会增删，
+    // 异步加载的回调也可能在那时查找，所以要加锁，不要在热路径上逐帧调用。
+    SkeletonHandle find_skeleton(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _skeletons.find(name);
+    }
+    ClipHandle find_clip(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _clips.find(name);
+    }
+    MeshHandle find_mesh(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _meshes.find(name);
+    }
+
+    // 以下只能在主线程的帧边界调用，此时没有其他线程在读取。
+    // 登记 AssetLoader::drain 发布的文件，不是经由这里加载的文件直接忽略。
+    // 热重载时按块名原地更新，已有的句柄保持不变。
+    void publish(AssetLoadHandle file, const AssetFile* data);
+    // 销毁引用计数已经归零的文件中的资源，并释放对应的加载请求。
+    void collect();
+
+private:
+    struct Slot {
+        std::string name;
+        // 所属文件的加载句柄，空闲时为 0。
+        uint32_t owner = 0;
+        // 最近一次登记时的编号，用来找出新版本中已经不存在的块。
+        uint32_t stamp = 0;
+        uint32_t generation = 0;
+    };
+
+    // 资源本身连续存放，名字这类只在增删时用到的数据放在 slots 里，
+    // 不占用读取路径上的缓存。
+    template <typename T>
+    struct Pool {
+        std::unique_ptr<T[]> items;
+        // 每个槽位当前有效的句柄，空闲时为 0。
+        std::unique_ptr<std::atomic<uint32_t>[]> handles;
+        std::unique_ptr<Slot[]> slots;
+        std::vector<uint32_t> free;
+        std::unordered_map<std::string, uint32_t> names;
+        uint32_t capacity = 0;
+
+        const T* get(AssetHandle<T> handle) const {
+            uint32_t index = handle.value & 0xffff;
+            if (!handle.valid() || index >= capacity ||
+                handles[index].load(std::memory_order_acquire) !=
+                    handle.value) {
+                return nullptr;
+            }
+            return &items[index];
+        }
+
+        AssetHandle<T> find(const std::string& name) const {
+            auto it = names.find(name);
+            if (it == names.end()) {
+                return AssetHandle<T>();
+            }
+            return AssetHandle<T>{
+                handles[it->second].load(std::memory_order_acquire)};
+        }
+    };
+
+    struct File {
+        std::string path;
+        unsigned int count = 0;
+        // 各类型资源在对应 Pool 中的槽位。
+        std::vector<uint32_t> skeletons;
+        std::vector<uint32_t> clips;
+        std::vector<uint32_t> meshes;
+    };
+
+    template <typename T>
+    static void init_pool(Pool<T>& pool, unsigned int capacity);
+    template <typename T>
+    static void clear_pool(Pool<T>& pool);
+    template <typename T>
+    bool bind(Pool<T>& pool, const std::string& name, uint32_t owner,
+              std::vector<uint32_t>& bound, uint32_t& index);
+    template <typename T>
+    void remove_stale(Pool<T>& pool, const std::vector<uint32_t>& bound);
+    template <typename T>
+    static void remove(Pool<T>& pool, uint32_t index);
+
+    AssetLoader* _loader;
+
+    Pool<Skeleton> _skeletons;
+    Pool<CompressedClip> _clips;
+    Pool<SkinnedMeshView> _meshes;
+    uint32_t _stamp;
+
+    // 保护文件表和各 Pool 的名字表，load / release / find_* 可能来自
+    // 模拟线程或工作线程。
+    mutable std::mutex _mutex;
+    // 以加载句柄为键。
+    std::unordered_map<uint32_t, File> _files;
+    std::unordered_map<std::string, uint32_t> _paths;
+    // 引用计数归零、等待 collect 的文件。
+    std::vector<uint32_t> _released;
+};
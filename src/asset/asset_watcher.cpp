@@ -0,0 +1,286 @@
+#include "asset_watcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "../core/profiler.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+AssetWatcher::AssetWatcher()
+    : _callback{nullptr}, _user{nullptr}, _poll_interval_ms{500},
+      _stop{false}, _inotify_fd{-1}, _wake_fd{-1} {}
+
+AssetWatcher::~AssetWatcher() { shutdown(); }
+
+bool AssetWatcher::init(AssetChangeCallback callback, void* user,
+                        unsigned int poll_interval_ms) {
+    if (_thread.joinable()) {
+        return true;
+    }
+
+    _callback = callback;
+    _user = user;
+    _poll_interval_ms = std::max(poll_interval_ms, 1u);
+    _stop = false;
+
+#ifdef __linux__
+    _inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotify_fd >= 0) {
+        _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_wake_fd < 0) {
+            ::close(_inotify_fd);
+            _inotify_fd = -1;
+        }
+    }
+    if (_inotify_fd < 0) {
+        spdlog::warn("inotify unavailable ({}), polling for asset changes.",
+                     std::strerror(errno));
+    }
+    if (_inotify_fd >= 0) {
+        _thread = std::thread(&AssetWatcher::inotify_main, this);
+        return true;
+    }
+#endif
+
+    _thread = std::thread(&AssetWatcher::poll_main, this);
+    return true;
+}
+
+void AssetWatcher::shutdown() {
+    if (!_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _stop_cv.notify_all();
+#ifdef __linux__
+    if (_wake_fd >= 0) {
+        uint64_t one = 1;
+        if (::write(_wake_fd, &one, sizeof(one)) < 0) {
+            spdlog::error("wake asset watcher failed: {}",
+                          std::strerror(errno));
+        }
+    }
+#endif
+    _thread.join();
+
+#ifdef __linux__
+    if (_inotify_fd >= 0) {
+        ::close(_inotify_fd);
+        _inotify_fd = -1;
+    }
+    if (_wake_fd >= 0) {
+        ::close(_wake_fd);
+        _wake_fd = -1;
+    }
+#endif
+    _files.clear();
+    _directories.clear();
+}
+
+void AssetWatcher::watch(const std::string& path) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    File& file = _files[path];
+    if (file.count++ > 0) {
+        return;
+    }
+
+    fs::path location(path);
+    file.directory = location.parent_path().string();
+    if (file.directory.empty()) {
+        file.directory = ".";
+    }
+    file.name = location.filename().string();
+    stat_file(path, file.mtime, file.size);
+
+#ifdef __linux__
+    if (_inotify_fd < 0) {
+        return;
+    }
+
+    // 监视目录而不是文件本身，改名替换后 inode 变了也不会丢。
+    Directory& directory = _directories[file.directory];
+    if (directory.count++ == 0) {
+        directory.wd = inotify_add_watch(_inotify_fd, file.directory.c_str(),
+                                         IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (directory.wd < 0) {
+            spdlog::warn("watch directory failed: {} ({})", file.directory,
+                         std::strerror(errno));
+        }
+    }
+#endif
+}
+
+void AssetWatcher::unwatch(const std::string& path) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _files.find(path);
+    if (it == _files.end() || --it->second.count > 0) {
+        return;
+    }
+
+#ifdef __linux__
+    auto directory = _directories.find(it->second.directory);
+    if (directory != _directories.end() && --directory->second.count == 0) {
+        if (directory->second.wd >= 0) {
+            inotify_rm_watch(_inotify_fd, directory->second.wd);
+        }
+        _directories.erase(directory);
+    }
+#endif
+    _files.erase(it);
+}
+
+#ifdef __linux__
+
+void AssetWatcher::inotify_main() {
+    Profiler::set_thread_name("asset watcher");
+
+    pollfd fds[2] = {{_inotify_fd, POLLIN, 0}, {_wake_fd, POLLIN, 0}};
+    alignas(inotify_event) char buffer[4096];
+    std::vector<std::string> changed;
+    for (;;) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            spdlog::error("poll asset watcher failed: {}",
+                          std::strerror(errno));
+            return;
+        }
+
+        ssize_t size = 0;
+        changed.clear();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stop) {
+                return;
+            }
+            size = ::read(_inotify_fd, buffer, sizeof(buffer));
+
+            for (ssize_t offset = 0; offset < size;) {
+                const auto* event =
+                    reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                // 内核队列溢出丢了事件，只能当作所有文件都变了。
+                if (event->mask & IN_Q_OVERFLOW) {
+                    for (const auto& file : _files) {
+                        changed.push_back(file.first);
+                    }
+                    continue;
+                }
+                if (event->len == 0) {
+                    continue;
+                }
+
+                for (const auto& directory : _directories) {
+                    if (directory.second.wd != event->wd) {
+                        continue;
+                    }
+                    for (const auto& file : _files) {
+                        if (file.second.directory == directory.first &&
+                            file.second.name == event->name) {
+                            changed.push_back(file.first);
+                        }
+                    }
+                }
+            }
+        }
+
+        // 同一次读到的重复事件只回调一次。
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()),
+                      changed.end());
+        for (const std::string& path : changed) {
+            _callback(_user, path);
+        }
+    }
+}
+
+#endif
+
+void AssetWatcher::poll_main() {
+    Profiler::set_thread_name("asset watcher");
+
+    struct Sample {
+        std::string path;
+        int64_t mtime;
+        uint64_t size;
+        bool ok;
+    };
+    std::vector<Sample> samples;
+    std::vector<std::string> changed;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _stop_cv.wait_for(lock, std::chrono::milliseconds(_poll_interval_ms),
+                          [this] { return _stop; });
+        if (_stop) {
+            return;
+        }
+
+        // 在锁外查询文件状态，查询可能很慢。
+        samples.clear();
+        for (const auto& file : _files) {
+            samples.push_back(Sample{file.first, 0, 0, false});
+        }
+        lock.unlock();
+        for (Sample& sample : samples) {
+            sample.ok = stat_file(sample.path, sample.mtime, sample.size);
+        }
+        lock.lock();
+
+        changed.clear();
+        for (const Sample& sample : samples) {
+            auto it = _files.find(sample.path);
+            if (!sample.ok || it == _files.end() ||
+                (it->second.mtime == sample.mtime &&
+                 it->second.size == sample.size)) {
+                continue;
+            }
+            it->second.mtime = sample.mtime;
+            it->second.size = sample.size;
+            changed.push_back(sample.path);
+        }
+
+        lock.unlock();
+        for (const std::string& path : changed) {
+            _callback(_user, path);
+        }
+        lock.lock();
+    }
+}
+
+bool AssetWatcher::stat_file(const std::string& path, int64_t& mtime,
+                             uint64_t& size) const {
+    std::error_code error;
+    auto time = fs::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+    uintmax_t bytes = fs::file_size(path, error);
+    if (error) {
+        return false;
+    }
+
+    mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    size = static_cast<uint64_t>(bytes);
+    return true;
+}
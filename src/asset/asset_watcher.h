@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+using AssetChangeCallback = void (*)(void* user, const std::string& path);
+
+// 监视文件的修改，在后台线程上回调。Linux 上用 inotify 监视所在目录，
+// 这样写临时文件再改名的方式也能收到；其他平台或 inotify 不可用时定期比较
+// 修改时间和大小。回调时不持有内部的锁，回调里可以调用 watch / unwatch。
+class AssetWatcher final {
+public:
+    AssetWatcher();
+    ~AssetWatcher();
+    AssetWatcher(const AssetWatcher&) = delete;
+    AssetWatcher(AssetWatcher&&) = delete;
+
+    AssetWatcher& operator=(const AssetWatcher&) = delete;
+    AssetWatcher& operator=(AssetWatcher&&) = delete;
+
+    [[nodiscard]] bool init(AssetChangeCallback callback, void* user,
+                            unsigned int poll_interval_ms = 500);
+    void shutdown();
+
+    bool using_inotify() const { return _inotify_fd >= 0; }
+
+    // 线程安全，按次数配对，最后一次 unwatch 后才停止监视。
+    // 路径按原样比较，回调时也原样交回。
+    void watch(const std::string& path);
+    void unwatch(const std::string& path);
+
+private:
+    struct File {
+        std::string directory;
+        std::string name;
+        unsigned int count = 0;
+        // 轮询时用来判断是否变化。
+        int64_t mtime = 0;
+        uint64_t size = 0;
+    };
+
+    struct Directory {
+        int wd = -1;
+        unsigned int count = 0;
+    };
+
+    void inotify_main();
+    void poll_main();
+    bool stat_file(const std::string& path, int64_t& mtime,
+                   uint64_t& size) const;
+
+    AssetChangeCallback _callback;
+    void* _user;
+    unsigned int _poll_interval_ms;
+
+    std::mutex _mutex;
+    std::condition_variable _stop_cv;
+    bool _stop;
+    std::unordered_map<std::string, File> _files;
+    std::unordered_map<std::string, Directory> _directories;
+
+    int _inotify_fd;
+    // 写入后唤醒阻塞在 poll 上的监视线程。
+    int _wake_fd;
+    std::thread _thread;
+};
@@ -0,0 +1,1235 @@
+#include "gltf_importer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include <spdlog/spdlog.h>
+
+#include "../core/profiler.h"
+#include "../math/mat4.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+
+namespace {
+
+constexpr uint32_t GLB_MAGIC = 0x46546c67;
+constexpr uint32_t GLB_VERSION = 2;
+constexpr uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004e4942;
+
+constexpr int GLTF_BYTE = 5120;
+constexpr int GLTF_UNSIGNED_BYTE = 5121;
+constexpr int GLTF_SHORT = 5122;
+constexpr int GLTF_UNSIGNED_SHORT = 5123;
+constexpr int GLTF_UNSIGNED_INT = 5125;
+constexpr int GLTF_FLOAT = 5126;
+
+constexpr int GLTF_TRIANGLES = 4;
+
+enum class ChannelPath {
+    Translation,
+    Rotation,
+    Scale,
+    Other,
+};
+
+struct GltfNode {
+    std::string name;
+    std::vector<int> children;
+    int parent = -1;
+    int mesh = -1;
+    int skin = -1;
+    Transform transform;
+};
+
+struct GltfSkin {
+    std::vector<int> joints;
+    int inverse_bind_matrices = -1;
+};
+
+struct GltfAccessor {
+    int buffer_view = -1;
+    uint64_t offset = 0;
+    int component_type = 0;
+    int num_components = 0;
+    uint32_t count = 0;
+    bool normalized = false;
+    bool sparse = false;
+};
+
+struct GltfBufferView {
+    int buffer = -1;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    uint32_t stride = 0;
+};
+
+struct GltfBuffer {
+    std::string uri;
+    uint64_t length = 0;
+    const uint8_t* data = nullptr;
+};
+
+struct GltfPrimitive {
+    int positions = -1;
+    int normals = -1;
+    int uvs = -1;
+    int joints = -1;
+    int weights = -1;
+    int indices = -1;
+    int mode = GLTF_TRIANGLES;
+};
+
+struct GltfMeshDesc {
+    std::string name;
+    std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfSampler {
+    int input = -1;
+    int output = -1;
+    Interpolation interpolation = Interpolation::Linear;
+};
+
+struct GltfChannel {
+    int sampler = -1;
+    int node = -1;
+    ChannelPath path = ChannelPath::Other;
+};
+
+struct GltfAnimation {
+    std::string name;
+    std::vector<GltfSampler> samplers;
+    std::vector<GltfChannel> channels;
+};
+
+struct GltfDocument {
+    std::vector<GltfNode> nodes;
+    std::vector<GltfSkin> skins;
+    std::vector<GltfMeshDesc> meshes;
+    std::vector<GltfAccessor> accessors;
+    std::vector<GltfBufferView> buffer_views;
+    std::vector<GltfBuffer> buffers;
+    std::vector<GltfAnimation> animations;
+
+    // 缓冲区数据的归属：映射的外部文件和解码后的 data URI，地址不随容器搬移。
+    std::vector<MappedFile> files;
+    std::vector<std::vector<uint8_t>> decoded;
+};
+
+template <typename F>
+bool for_each_member(JsonReader& reader, F&& fn) {
+    std::string_view key;
+    if (!reader.begin_object()) {
+        return false;
+    }
+    while (reader.next_key(key)) {
+        if (!fn(key)) {
+            return false;
+        }
+    }
+    return !reader.failed();
+}
+
+template <typename F>
+bool for_each_element(JsonReader& reader, F&& fn) {
+    if (!reader.begin_array()) {
+        return false;
+    }
+    while (reader.next_element()) {
+        if (!fn()) {
+            return false;
+        }
+    }
+    return !reader.failed();
+}
+
+template <typename T, typename F>
+bool read_objects(JsonReader& reader, std::vector<T>& out, F&& parse) {
+    return for_each_element(reader, [&] {
+        out.emplace_back();
+        return parse(reader, out.back());
+    });
+}
+
+bool read_floats(JsonReader& reader, float* out, int count) {
+    int size = 0;
+    bool ok = for_each_element(reader, [&] {
+        return size < count ? reader.read_float(out[size++]) : false;
+    });
+    return ok && size == count;
+}
+
+bool read_ints(JsonReader& reader, std::vector<int>& out) {
+    return for_each_element(reader, [&] {
+        out.emplace_back();
+        return reader.read_int(out.back());
+    });
+}
+
+int components_of(std::string_view type) {
+    if (type == "SCALAR") {
+        return 1;
+    }
+    if (type == "VEC2") {
+        return 2;
+    }
+    if (type == "VEC3") {
+        return 3;
+    }
+    if (type == "VEC4") {
+        return 4;
+    }
+    // MAT2/MAT3 的列有对齐填充，这里用不到，统一视为不支持。
+    return type == "MAT4" ? 16 : 0;
+}
+
+int component_size(int type) {
+    switch (type) {
+        case GLTF_BYTE:
+        case GLTF_UNSIGNED_BYTE:
+            return 1;
+        case GLTF_SHORT:
+        case GLTF_UNSIGNED_SHORT:
+            return 2;
+        case GLTF_UNSIGNED_INT:
+        case GLTF_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+bool parse_node(JsonReader& reader, GltfNode& node) {
+    float matrix[16];
+    bool has_matrix = false;
+    bool ok = for_each_member(reader, [&](std::string_view key) {
+        if (key == "name") {
+            return reader.read_string(node.name);
+        }
+        if (key == "children") {
+            return read_ints(reader, node.children);
+        }
+        if (key == "mesh") {
+            return reader.read_int(node.mesh);
+        }
+        if (key == "skin") {
+            return reader.read_int(node.skin);
+        }
+        if (key == "matrix") {
+            has_matrix = true;
+            return read_floats(reader, matrix, 16);
+        }
+        if (key == "translation") {
+            return read_floats(reader, node.transform.position.v, 3);
+        }
+        if (key == "rotation") {
+            return read_floats(reader, node.transform.rotation.v, 4);
+        }
+        if (key == "scale") {
+            return read_floats(reader, node.transform.scale.v, 3);
+        }
+        return reader.skip();
+    });
+
+    if (has_matrix) {
+        node.transform = mat4_to_transform(Mat4(matrix));
+    }
+    return ok;
+}
+
+bool parse_skin(JsonReader& reader, GltfSkin& skin) {
+    return for_each_member(reader, [&](std::string_view key) {
+        if (key == "joints") {
+            return read_ints(reader, skin.joints);
+        }
+        if (key == "inverseBindMatrices") {
+            return reader.read_int(skin.inverse_bind_matrices);
+        }
+        return reader.skip();
+    });
+}
+
+bool parse_accessor(JsonReader& reader, GltfAccessor& accessor) {
+    std::string type;
+    uint64_t count = 0;
+    bool ok = for_each_member(reader, [&](std::string_view key) {
+        if (key == "bufferView") {
+            return reader.read_int(accessor.buffer_view);
+        }
+        if (key == "byteOffset") {
+            return reader.read_uint64(accessor.offset);
+        }
+        if (key == "componentType") {
+            return reader.read_int(accessor.component_type);
+        }
+        if (key == "normalized") {
+            return reader.read_bool(accessor.normalized);
+        }
+        if (key == "count") {
+            return reader.read_uint64(count);
+        }
+        if (key == "type") {
+            return reader.read_string(type);
+        }
+        if (key == "sparse") {
+            accessor.sparse = true;
+        }
+        return reader.skip();
+    });
+
+    accessor.num_components = components_of(type);
+    accessor.count = static_cast<uint32_t>(std::min<uint64_t>(count, ~0u));
+    return ok;
+}
+
+bool parse_buffer_view(JsonReader& reader, GltfBufferView& view) {
+    return for_each_member(reader, [&](std::string_view key) {
+        if (key == "buffer") {
+            return reader.read_int(view.buffer);
+        }
+        if (key == "byteOffset") {
+            return reader.read_uint64(view.offset);
+        }
+        if (key == "byteLength") {
+            return reader.read_uint64(view.length);
+        }
+        if (key == "byteStride") {
+            int stride = 0;
+            bool ok = reader.read_int(stride);
+            view.stride = static_cast<uint32_t>(std::max(stride, 0));
+            return ok;
+        }
+        return reader.skip();
+    });
+}
+
+bool parse_buffer(JsonReader& reader, GltfBuffer& buffer) {
+    return for_each_member(reader, [&](std::string_view key) {
+        if (key == "uri") {
+            return reader.read_string(buffer.uri);
+        }
+        if (key == "byteLength") {
+            return reader.read_uint64(buffer.length);
+        }
+        return reader.skip();
+    });
+}
+
+bool parse_primitive(JsonReader& reader, GltfPrimitive& primitive) {
+    return for_each_member(reader, [&](std::string_view key) {
+        if (key == "attributes") {
+            return for_each_member(reader, [&](std::string_view name) {
+                if (name == "POSITION") {
+                    return reader.read_int(primitive.positions);
+                }
+                if (name == "NORMAL") {
+                    return reader.read_int(primitive.normals);
+                }
+                if (name == "TEXCOORD_0") {
+                    return reader.read_int(primitive.uvs);
+                }
+                if (name == "JOINTS_0") {
+                    return reader.read_int(primitive.joints);
+                }
+                if (name == "WEIGHTS_0") {
+                    return reader.read_int(primitive.weights);
+                }
+                return reader.skip();
+            });
+        }
+        if (key == "indices") {
+            return reader.read_int(primitive.indices);
+        }
+        if (key == "mode") {
+            return reader.read_int(primitive.mode);
+        }
+        return reader.skip();
+    });
+}
+
+bool parse_mesh(JsonReader& reader, GltfMeshDesc& mesh) {
+    return for_each_member(reader, [&](std::string_view key) {
+        if (key == "name") {
+            return reader.read_string(mesh.name);
+        }
+        if (key == "primitives") {
+            return read_objects(reader, mesh.primitives, parse_primitive);
+        }
+        return reader.skip();
+    });
+}
+
+bool parse_sampler(JsonReader& reader, GltfSampler& sampler) {
+    std::string interpolation;
+    bool ok = for_each_member(reader, [&](std::string_view key) {
+        if (key == "input") {
+            return reader.read_int(sampler.input);
+        }
+        if (key == "output") {
+            return reader.read_int(sampler.output);
+        }
+        if (key == "interpolation") {
+            return reader.read_string(interpolation);
+        }
+        return reader.skip();
+    });
+
+    if (interpolation == "STEP") {
+        sampler.interpolation = Interpolation::Constant;
+    } else if (interpolation == "CUBICSPLINE") {
+        sampler.interpolation = Interpolation::Cubic;
+    }
+    return ok;
+}
+
+bool parse_channel(JsonReader& reader, GltfChannel& channel) {
+    std::string path;
+    bool ok = for_each_member(reader, [&](std::string_view key) {
+        if (key == "sampler") {
+            return reader.read_int(channel.sampler);
+        }
+        if (key == "target") {
+            return for_each_member(reader, [&](std::string_view name) {
+                if (name == "node") {
+                    return reader.read_int(channel.node);
+                }
+                if (name == "path") {
+                    return reader.read_string(path);
+                }
+                return reader.skip();
+            });
+        }
+        return reader.skip();
+    });
+
+    if (path == "translation") {
+        channel.path = ChannelPath::Translation;
+    } else if (path == "rotation") {
+        channel.path = ChannelPath::Rotation;
+    } else if (path == "scale") {
+        channel.path = ChannelPath::Scale;
+    }
+    return ok;
+}
+
+bool parse_animation(JsonReader& reader, GltfAnimation& animation) {
+    return for_each_member(reader, [&](std::string_view key) {
+        if (key == "name") {
+            return reader.read_string(animation.name);
+        }
+        if (key == "samplers") {
+            return read_objects(reader, animation.samplers, parse_sampler);
+        }
+        if (key == "channels") {
+            return read_objects(reader, animation.channels, parse_channel);
+        }
+        return reader.skip();
+    });
+}
+
+bool parse_document(JsonReader& reader, GltfDocument& doc) {
+    std::string scratch;
+    bool supported = true;
+    bool ok = for_each_member(reader, [&](std::string_view key) {
+        if (key == "nodes") {
+            return read_objects(reader, doc.nodes, parse_node);
+        }
+        if (key == "skins") {
+            return read_objects(reader, doc.skins, parse_skin);
+        }
+        if (key == "meshes") {
+            return read_objects(reader, doc.meshes, parse_mesh);
+        }
+        if (key == "accessors") {
+            return read_objects(reader, doc.accessors, parse_accessor);
+        }
+        if (key == "bufferViews") {
+            return read_objects(reader, doc.buffer_views, parse_buffer_view);
+        }
+        if (key == "buffers") {
+            return read_objects(reader, doc.buffers, parse_buffer);
+        }
+        if (key == "animations") {
+            return read_objects(reader, doc.animations, parse_animation);
+        }
+        if (key == "extensionsRequired") {
+            // Draco、meshopt 等压缩扩展会改变缓冲区的含义，不能假装读懂。
+            return for_each_element(reader, [&] {
+                if (!reader.read_string(scratch)) {
+                    return false;
+                }
+                spdlog::error("required glTF extension unsupported: {}",
+                              scratch);
+                supported = false;
+                return true;
+            });
+        }
+        return reader.skip();
+    });
+
+    if (!ok) {
+        spdlog::error("glTF json error at byte {}: {}", reader.offset(),
+                      reader.failed() ? reader.error() : "invalid value");
+    }
+    return ok && supported;
+}
+
+int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '+' || c == '-') {
+        return 62;
+    }
+    if (c == '/' || c == '_') {
+        return 63;
+    }
+    return -1;
+}
+
+bool decode_base64(std::string_view text, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(text.size() / 4 * 3);
+
+    uint32_t bits = 0;
+    int num_bits = 0;
+    for (char c : text) {
+        if (c == '=') {
+            break;
+        }
+        int value = base64_value(c);
+        if (value < 0) {
+            return false;
+        }
+        bits = bits << 6 | static_cast<uint32_t>(value);
+        num_bits += 6;
+        if (num_bits >= 8) {
+            num_bits -= 8;
+            out.push_back(static_cast<uint8_t>(bits >> num_bits));
+        }
+    }
+    return true;
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// 相对路径里的空格等字符会以 %XX 的形式出现。
+std::string decode_uri(const std::string& uri) {
+    std::string out;
+    for (size_t i = 0; i < uri.size(); ++i) {
+        int high = i + 2 < uri.size() ? hex_value(uri[i + 1]) : -1;
+        int low = i + 2 < uri.size() ? hex_value(uri[i + 2]) : -1;
+        if (uri[i] == '%' && high >= 0 && low >= 0) {
+            out.push_back(static_cast<char>(high << 4 | low));
+            i += 2;
+        } else {
+            out.push_back(uri[i]);
+        }
+    }
+    return out;
+}
+
+bool load_buffers(GltfDocument& doc, const std::string& directory,
+                  const uint8_t* glb_data, size_t glb_size,
+                  std::vector<std::string>& dependencies) {
+    for (size_t i = 0; i < doc.buffers.size(); ++i) {
+        GltfBuffer& buffer = doc.buffers[i];
+        size_t size = 0;
+
+        if (buffer.uri.empty()) {
+            // 只有 GLB 的第一个缓冲区可以省略 uri，指向 BIN 块。
+            if (i != 0 || !glb_data) {
+                spdlog::error("glTF buffer {} has no data.", i);
+                return false;
+            }
+            buffer.data = glb_data;
+            size = glb_size;
+        } else if (buffer.uri.compare(0, 5, "data:") == 0) {
+            size_t comma = buffer.uri.find(";base64,");
+            doc.decoded.emplace_back();
+            if (comma == std::string::npos ||
+                !decode_base64(std::string_view(buffer.uri).substr(comma + 8),
+                               doc.decoded.back())) {
+                spdlog::error("glTF buffer {} has an invalid data uri.", i);
+                return false;
+            }
+            buffer.data = doc.decoded.back().data();
+            size = doc.decoded.back().size();
+            // 数据已经解码，释放 base64 原文。
+            std::string().swap(buffer.uri);
+        } else {
+            MappedFile file;
+            std::string buffer_path = directory + decode_uri(buffer.uri);
+            if (!file.open(buffer_path)) {
+                return false;
+            }
+            dependencies.push_back(std::move(buffer_path));
+            buffer.data = file.data();
+            size = file.size();
+            doc.files.push_back(std::move(file));
+        }
+
+        if (size < buffer.length) {
+            spdlog::error("glTF buffer {} is truncated: {} of {} bytes.", i,
+                          size, buffer.length);
+            return false;
+        }
+    }
+    return true;
+}
+
+// 直接从缓冲区按步长读取元素，按需完成整数到浮点的转换和归一化。
+class AccessorReader {
+public:
+    AccessorReader()
+        : _data{nullptr}, _stride{0}, _count{0}, _component_type{0},
+          _num_components{0}, _normalized{false} {}
+
+    bool init(const GltfDocument& doc, int index, int num_components);
+
+    uint32_t count() const { return _count; }
+    int component_type() const { return _component_type; }
+
+    void read(uint32_t index, float* out) const {
+        if (!_data) {
+            std::fill(out, out + _num_components, 0.0f);
+            return;
+        }
+        const uint8_t* element = _data + static_cast<size_t>(index) * _stride;
+        int size = component_size(_component_type);
+        for (int i = 0; i < _num_components; ++i) {
+            out[i] = read_float(element + i * size);
+        }
+    }
+
+    uint32_t read_uint(uint32_t index, int component) const {
+        if (!_data) {
+            return 0;
+        }
+        const uint8_t* p = _data + static_cast<size_t>(index) * _stride +
+                           component * component_size(_component_type);
+        switch (_component_type) {
+            case GLTF_UNSIGNED_BYTE:
+                return *p;
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t value;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+            default: {
+                uint32_t value;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+        }
+    }
+
+private:
+    float read_float(const uint8_t* p) const {
+        switch (_component_type) {
+            case GLTF_FLOAT: {
+                float value;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+            case GLTF_BYTE: {
+                auto value = static_cast<float>(static_cast<int8_t>(*p));
+                return _normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case GLTF_UNSIGNED_BYTE:
+                return _normalized ? *p / 255.0f : *p;
+            case GLTF_SHORT: {
+                int16_t value;
+                std::memcpy(&value, p, sizeof(value));
+                return _normalized ? std::max(value / 32767.0f, -1.0f)
+                                   : value;
+            }
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t value;
+                std::memcpy(&value, p, sizeof(value));
+                return _normalized ? value / 65535.0f : value;
+            }
+            default: {
+                uint32_t value;
+                std::memcpy(&value, p, sizeof(value));
+                return static_cast<float>(value);
+            }
+        }
+    }
+
+    const uint8_t* _data;
+    size_t _stride;
+    uint32_t _count;
+    int _component_type;
+    int _num_components;
+    bool _normalized;
+};
+
+bool AccessorReader::init(const GltfDocument& doc, int index,
+                          int num_components) {
+    if (index < 0 || static_cast<size_t>(index) >= doc.accessors.size()) {
+        spdlog::error("glTF accessor {} out of range.", index);
+        return false;
+    }
+
+    const GltfAccessor& accessor = doc.accessors[index];
+    int size = component_size(accessor.component_type);
+    if (accessor.num_components != num_components || size == 0) {
+        spdlog::error("glTF accessor {} has unexpected type.", index);
+        return false;
+    }
+    if (accessor.sparse) {
+        spdlog::error("glTF sparse accessor {} unsupported.", index);
+        return false;
+    }
+
+    _count = accessor.count;
+    _component_type = accessor.component_type;
+    _num_components = num_components;
+    _normalized = accessor.normalized;
+    _stride = static_cast<size_t>(size) * num_components;
+    _data = nullptr;
+
+    // 没有 bufferView 的访问器按规范全部为零。
+    if (accessor.buffer_view < 0) {
+        return true;
+    }
+    if (static_cast<size_t>(accessor.buffer_view) >= doc.buffer_views.size()) {
+        spdlog::error("glTF accessor {} has invalid buffer view.", index);
+        return false;
+    }
+
+    const GltfBufferView& view = doc.buffer_views[accessor.buffer_view];
+    if (view.buffer < 0 ||
+        static_cast<size_t>(view.buffer) >= doc.buffers.size()) {
+        spdlog::error("glTF buffer view {} has invalid buffer.",
+                      accessor.buffer_view);
+        return false;
+    }
+
+    const GltfBuffer& buffer = doc.buffers[view.buffer];
+    size_t element_size = _stride;
+    if (view.stride > 0) {
+        _stride = view.stride;
+    }
+
+    uint64_t needed = _count == 0 ? 0
+                                  : accessor.offset +
+                                        uint64_t{_stride} * (_count - 1) +
+                                        element_size;
+    if (view.offset + view.length > buffer.length || needed > view.length) {
+        spdlog::error("glTF accessor {} exceeds its buffer.", index);
+        return false;
+    }
+
+    _data = buffer.data + view.offset + accessor.offset;
+    return true;
+}
+
+bool link_parents(GltfDocument& doc) {
+    int num_nodes = static_cast<int>(doc.nodes.size());
+    for (int i = 0; i < num_nodes; ++i) {
+        for (int child : doc.nodes[i].children) {
+            if (child < 0 || child >= num_nodes ||
+                doc.nodes[child].parent >= 0) {
+                spdlog::error("glTF node {} has an invalid child {}.", i,
+                              child);
+                return false;
+            }
+            doc.nodes[child].parent = i;
+        }
+    }
+
+    // 每条父链的长度都不能超过节点总数，否则说明有环。
+    for (int i = 0; i < num_nodes; ++i) {
+        int depth = 0;
+        for (int p = doc.nodes[i].parent; p >= 0; p = doc.nodes[p].parent) {
+            if (++depth > num_nodes) {
+                spdlog::error("glTF node hierarchy has a cycle.");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool is_identity(const Transform& t) {
+    return t.position == Vec3() && t.rotation == Quat() &&
+           t.scale == Vec3(1.0f, 1.0f, 1.0f);
+}
+
+struct JointMapping {
+    std::vector<int> node_to_joint;
+    // 关节与其父关节之间（或根关节之上）非关节节点的累积变换。
+    std::vector<Transform> offsets;
+    std::vector<bool> has_offset;
+};
+
+bool build_skeleton(const GltfDocument& doc, Skeleton& skeleton,
+                    JointMapping& mapping) {
+    std::vector<int> joints;
+    const GltfSkin* skin = doc.skins.empty() ? nullptr : &doc.skins[0];
+    if (skin) {
+        joints = skin->joints;
+        if (doc.skins.size() > 1) {
+            spdlog::warn("glTF has {} skins, only the first is imported.",
+                         doc.skins.size());
+        }
+    } else {
+        joints.resize(doc.nodes.size());
+        for (size_t i = 0; i < joints.size(); ++i) {
+            joints[i] = static_cast<int>(i);
+        }
+    }
+
+    unsigned int num_joints = static_cast<unsigned int>(joints.size());
+    mapping.node_to_joint.assign(doc.nodes.size(), -1);
+    mapping.offsets.assign(num_joints, Transform());
+    mapping.has_offset.assign(num_joints, false);
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        int node = joints[i];
+        if (node < 0 || static_cast<size_t>(node) >= doc.nodes.size() ||
+            mapping.node_to_joint[node] >= 0) {
+            spdlog::error("glTF skin has an invalid joint {}.", node);
+            return false;
+        }
+        mapping.node_to_joint[node] = static_cast<int>(i);
+    }
+
+    Pose rest(num_joints);
+    std::vector<std::string> names(num_joints);
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        const GltfNode& node = doc.nodes[joints[i]];
+        Transform offset;
+        int p = node.parent;
+        for (; p >= 0 && mapping.node_to_joint[p] < 0;
+             p = doc.nodes[p].parent) {
+            offset = combine(doc.nodes[p].transform, offset);
+        }
+
+        mapping.offsets[i] = offset;
+        mapping.has_offset[i] = !is_identity(offset);
+        rest.set_parent(i, p >= 0 ? mapping.node_to_joint[p] : -1);
+        rest.set_local_transform(i, combine(offset, node.transform));
+        names[i] = node.name.empty() ? "joint " + std::to_string(i)
+                                     : node.name;
+    }
+
+    std::vector<Transform> world_bind(num_joints);
+    AccessorReader matrices;
+    bool has_matrices = skin && skin->inverse_bind_matrices >= 0;
+    if (has_matrices) {
+        if (!matrices.init(doc, skin->inverse_bind_matrices, 16) ||
+            matrices.count() < num_joints ||
+            matrices.component_type() != GLTF_FLOAT) {
+            spdlog::error("glTF inverse bind matrices are invalid.");
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        if (has_matrices) {
+            float m[16];
+            matrices.read(i, m);
+            world_bind[i] = mat4_to_transform(inverse(Mat4(m)));
+        } else {
+            world_bind[i] = rest.global_transform(i);
+        }
+    }
+
+    Pose bind = rest;
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        int parent = bind.parent(i);
+        Transform local = world_bind[i];
+        if (parent >= 0) {
+            local = combine(inverse(world_bind[parent]), local);
+        }
+        bind.set_local_transform(i, local);
+    }
+
+    skeleton.set(rest, bind, names);
+    return true;
+}
+
+// 把非关节祖先的变换并入关键帧。三个分量互相独立，切线同样是线性变换，
+// 所以逐个通道处理对 CUBICSPLINE 也是精确的（非均匀缩放除外）。
+void apply_offset(ChannelPath path, const Transform& offset, bool tangent,
+                  float* value) {
+    Transform t;
+    switch (path) {
+        case ChannelPath::Translation:
+            t.position = Vec3(value);
+            t.position = tangent ? transform_vector(offset, t.position)
+                                 : combine(offset, t).position;
+            std::memcpy(value, t.position.v, sizeof(float) * 3);
+            break;
+        case ChannelPath::Rotation:
+            t.rotation = Quat(value[0], value[1], value[2], value[3]);
+            std::memcpy(value, combine(offset, t).rotation.v,
+                        sizeof(float) * 4);
+            break;
+        case ChannelPath::Scale:
+            t.scale = Vec3(value);
+            std::memcpy(value, combine(offset, t).scale.v, sizeof(float) * 3);
+            break;
+        case ChannelPath::Other:
+            break;
+    }
+}
+
+template <typename T, unsigned int N>
+void fill_track(Track<T, N>& track, const AccessorReader& times,
+                const AccessorReader& values, Interpolation interpolation,
+                ChannelPath path, const Transform* offset) {
+    uint32_t num_keys = times.count();
+    bool cubic = interpolation == Interpolation::Cubic;
+    track.resize(num_keys);
+    track.set_interpolation(interpolation);
+
+    for (uint32_t i = 0; i < num_keys; ++i) {
+        Frame<N>& frame = track[i];
+        times.read(i, &frame.time);
+        if (cubic) {
+            // CUBICSPLINE 每个关键帧依次存入切线、值、出切线。
+            values.read(i * 3, frame.in);
+            values.read(i * 3 + 1, frame.value);
+            values.read(i * 3 + 2, frame.out);
+        } else {
+            values.read(i, frame.value);
+            std::fill(frame.in, frame.in + N, 0.0f);
+            std::fill(frame.out, frame.out + N, 0.0f);
+        }
+
+        if (offset) {
+            apply_offset(path, *offset, false, frame.value);
+            if (cubic) {
+                apply_offset(path, *offset, true, frame.in);
+                apply_offset(path, *offset, true, frame.out);
+            }
+        }
+    }
+}
+
+bool build_clip(const GltfDocument& doc, const GltfAnimation& animation,
+                const JointMapping& mapping, Clip& clip) {
+    unsigned int skipped = 0;
+    for (const GltfChannel& channel : animation.channels) {
+        if (channel.node < 0 ||
+            static_cast<size_t>(channel.node) >= doc.nodes.size() ||
+            channel.sampler < 0 ||
+            static_cast<size_t>(channel.sampler) >=
+                animation.samplers.size()) {
+            spdlog::error("glTF animation {} has an invalid channel.",
+                          clip.name());
+            return false;
+        }
+
+        int joint = mapping.node_to_joint[channel.node];
+        if (joint < 0 || channel.path == ChannelPath::Other) {
+            ++skipped;
+            continue;
+        }
+
+        const GltfSampler& sampler = animation.samplers[channel.sampler];
+        int num_components = channel.path == ChannelPath::Rotation ? 4 : 3;
+        uint32_t keys_per_frame =
+            sampler.interpolation == Interpolation::Cubic ? 3 : 1;
+        AccessorReader times;
+        AccessorReader values;
+        if (!times.init(doc, sampler.input, 1) ||
+            !values.init(doc, sampler.output, num_components) ||
+            values.count() != times.count() * keys_per_frame) {
+            spdlog::error("glTF animation {} has an invalid sampler.",
+                          clip.name());
+            return false;
+        }
+
+        TransformTrack& track = clip[static_cast<unsigned int>(joint)];
+        const Transform* offset =
+            mapping.has_offset[joint] ? &mapping.offsets[joint] : nullptr;
+        if (channel.path == ChannelPath::Translation) {
+            fill_track(track.position(), times, values, sampler.interpolation,
+                       channel.path, offset);
+        } else if (channel.path == ChannelPath::Rotation) {
+            fill_track(track.rotation(), times, values, sampler.interpolation,
+                       channel.path, offset);
+        } else {
+            fill_track(track.scale(), times, values, sampler.interpolation,
+                       channel.path, offset);
+        }
+    }
+
+    if (skipped > 0) {
+        spdlog::debug("glTF animation {}: skipped {} channels.", clip.name(),
+                      skipped);
+    }
+    clip.recalculate_duration();
+    return true;
+}
+
+bool build_mesh(const GltfDocument& doc, const GltfPrimitive& primitive,
+                unsigned int num_joints, SkinnedMeshData& out) {
+    AccessorReader positions;
+    AccessorReader joints;
+    AccessorReader weights;
+    if (!positions.init(doc, primitive.positions, 3) ||
+        !joints.init(doc, primitive.joints, 4) ||
+        !weights.init(doc, primitive.weights, 4)) {
+        return false;
+    }
+
+    uint32_t num_vertices = positions.count();
+    if (joints.count() != num_vertices || weights.count() != num_vertices ||
+        (joints.component_type() != GLTF_UNSIGNED_BYTE &&
+         joints.component_type() != GLTF_UNSIGNED_SHORT)) {
+        spdlog::error("glTF primitive has mismatched skin attributes.");
+        return false;
+    }
+
+    out.positions.resize(num_vertices);
+    out.joints.resize(num_vertices);
+    out.weights.resize(num_vertices);
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        positions.read(i, out.positions[i].v);
+        weights.read(i, out.weights[i].v);
+
+        // 导出工具常留下总和略偏离 1 的权重，这里顺手归一化。
+        float* weight = out.weights[i].v;
+        float sum = weight[0] + weight[1] + weight[2] + weight[3];
+        if (sum > 0.0f) {
+            for (int c = 0; c < 4; ++c) {
+                weight[c] /= sum;
+            }
+        }
+
+        for (int c = 0; c < 4; ++c) {
+            uint32_t joint = joints.read_uint(i, c);
+            if (joint >= num_joints) {
+                spdlog::error("glTF vertex {} references joint {}.", i,
+                              joint);
+                return false;
+            }
+            out.joints[i][c] = static_cast<uint16_t>(joint);
+        }
+    }
+
+    if (primitive.normals >= 0) {
+        AccessorReader normals;
+        if (!normals.init(doc, primitive.normals, 3) ||
+            normals.count() != num_vertices) {
+            return false;
+        }
+        out.normals.resize(num_vertices);
+        for (uint32_t i = 0; i < num_vertices; ++i) {
+            normals.read(i, out.normals[i].v);
+        }
+    }
+
+    if (primitive.uvs >= 0) {
+        AccessorReader uvs;
+        if (!uvs.init(doc, primitive.uvs, 2) || uvs.count() != num_vertices) {
+            return false;
+        }
+        out.uvs.resize(num_vertices);
+        for (uint32_t i = 0; i < num_vertices; ++i) {
+            uvs.read(i, out.uvs[i].v);
+        }
+    }
+
+    if (primitive.indices < 0) {
+        out.indices.resize(num_vertices);
+        for (uint32_t i = 0; i < num_vertices; ++i) {
+            out.indices[i] = i;
+        }
+    } else {
+        AccessorReader indices;
+        if (!indices.init(doc, primitive.indices, 1) ||
+            indices.component_type() == GLTF_FLOAT) {
+            return false;
+        }
+        out.indices.resize(indices.count());
+        for (uint32_t i = 0; i < indices.count(); ++i) {
+            out.indices[i] = indices.read_uint(i, 0);
+            if (out.indices[i] >= num_vertices) {
+                spdlog::error("glTF index {} out of range.", out.indices[i]);
+                return false;
+            }
+        }
+    }
+
+    if (out.indices.size() % 3 != 0) {
+        spdlog::error("glTF primitive is not a triangle list.");
+        return false;
+    }
+    return true;
+}
+
+bool build_meshes(const GltfDocument& doc, unsigned int num_joints,
+                  std::vector<GltfMesh>& out) {
+    std::vector<bool> imported(doc.meshes.size(), false);
+    unsigned int skipped = 0;
+    for (const GltfNode& node : doc.nodes) {
+        if (node.mesh < 0 ||
+            static_cast<size_t>(node.mesh) >= doc.meshes.size() ||
+            imported[node.mesh]) {
+            continue;
+        }
+        if (node.skin != 0) {
+            ++skipped;
+            continue;
+        }
+        imported[node.mesh] = true;
+
+        const GltfMeshDesc& mesh = doc.meshes[node.mesh];
+        for (size_t i = 0; i < mesh.primitives.size(); ++i) {
+            const GltfPrimitive& primitive = mesh.primitives[i];
+            if (primitive.mode != GLTF_TRIANGLES || primitive.positions < 0 ||
+                primitive.joints < 0 || primitive.weights < 0) {
+                ++skipped;
+                continue;
+            }
+
+            GltfMesh result;
+            result.name = mesh.name.empty()
+                              ? "mesh " + std::to_string(node.mesh)
+                              : mesh.name;
+            if (mesh.primitives.size() > 1) {
+                result.name += "." + std::to_string(i);
+            }
+            if (!build_mesh(doc, primitive, num_joints, result.data)) {
+                spdlog::error("glTF mesh {} is invalid.", result.name);
+                return false;
+            }
+            out.push_back(std::move(result));
+        }
+    }
+
+    if (skipped > 0) {
+        spdlog::info("glTF: skipped {} unskinned meshes or primitives.",
+                     skipped);
+    }
+    return true;
+}
+
+template <typename T>
+bool read_pod(const uint8_t* data, size_t size, size_t offset, T& out) {
+    if (offset > size || size - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&out, data + offset, sizeof(T));
+    return true;
+}
+
+// 在 GLB 容器中找出 JSON 块和可选的 BIN 块。
+bool split_glb(const uint8_t* data, size_t size, const char*& json,
+               size_t& json_size, const uint8_t*& bin, size_t& bin_size) {
+    uint32_t version = 0;
+    uint32_t length = 0;
+    if (!read_pod(data, size, 4, version) || !read_pod(data, size, 8, length) ||
+        version != GLB_VERSION || length > size) {
+        return false;
+    }
+
+    json = nullptr;
+    bin = nullptr;
+    for (size_t offset = 12; offset + 8 <= length;) {
+        uint32_t chunk_length = 0;
+        uint32_t chunk_type = 0;
+        read_pod(data, length, offset, chunk_length);
+        read_pod(data, length, offset + 4, chunk_type);
+        offset += 8;
+        if (chunk_length > length - offset) {
+            return false;
+        }
+
+        if (chunk_type == GLB_CHUNK_JSON && !json) {
+            json = reinterpret_cast<const char*>(data + offset);
+            json_size = chunk_length;
+        } else if (chunk_type == GLB_CHUNK_BIN && !bin) {
+            bin = data + offset;
+            bin_size = chunk_length;
+        }
+        offset += (chunk_length + 3) & ~size_t{3};
+    }
+    return json != nullptr;
+}
+
+} // namespace
+
+bool import_gltf(const std::string& path, GltfAsset& out) {
+    ANIM_PROFILE_SCOPE("import_gltf");
+
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    const char* json = reinterpret_cast<const char*>(file.data());
+    size_t json_size = file.size();
+    const uint8_t* bin = nullptr;
+    size_t bin_size = 0;
+    uint32_t magic = 0;
+    if (read_pod(file.data(), file.size(), 0, magic) && magic == GLB_MAGIC &&
+        !split_glb(file.data(), file.size(), json, json_size, bin,
+                   bin_size)) {
+        spdlog::error("invalid glb container: {}", path);
+        return false;
+    }
+
+    GltfDocument doc;
+    out.dependencies.clear();
+    JsonReader reader(json, json_size);
+    size_t slash = path.find_last_of("/\\");
+    std::string directory =
+        slash == std::string::npos ? "" : path.substr(0, slash + 1);
+    if (!parse_document(reader, doc) || !link_parents(doc) ||
+        !load_buffers(doc, directory, bin, bin_size, out.dependencies)) {
+        spdlog::error("import glTF failed: {}", path);
+        return false;
+    }
+
+    JointMapping mapping;
+    if (!build_skeleton(doc, out.skeleton, mapping)) {
+        spdlog::error("import glTF skeleton failed: {}", path);
+        return false;
+    }
+
+    out.clips.clear();
+    out.clips.resize(doc.animations.size());
+    for (size_t i = 0; i < doc.animations.size(); ++i) {
+        const std::string& name = doc.animations[i].name;
+        out.clips[i].set_name(name.empty() ? "animation " + std::to_string(i)
+                                           : name);
+        if (!build_clip(doc, doc.animations[i], mapping, out.clips[i])) {
+            return false;
+        }
+    }
+
+    out.meshes.clear();
+    if (!doc.skins.empty() &&
+        !build_meshes(doc, out.skeleton.size(), out.meshes)) {
+        return false;
+    }
+
+    spdlog::info("imported {}: {} joints, {} clips, {} meshes.", path,
+                 out.skeleton.size(), out.clips.size(), out.meshes.size());
+    return true;
+}
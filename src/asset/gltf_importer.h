@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../anim/clip.h"
+#include "../anim/skeleton.h"
+#include "skinned_mesh.h"
+
+struct GltfMesh {
+    std::string name;
+    SkinnedMeshData data;
+};
+
+struct GltfAsset {
+    Skeleton skeleton;
+    std::vector<Clip> clips;
+    std::vector<GltfMesh> meshes;
+    // 导入时读取的外部 .bin 文件，离线工具据此判断资源是否需要重新转换。
+    std::vector<std::string> dependencies;
+};
+
+// 离线工具：读取 .gltf（外部 .bin 或 data URI）和 .glb。
+// 骨架取第一个 skin 的关节顺序，没有 skin 时把所有节点都当作关节；
+// 关节之外的祖先节点变换并入根关节，动画中指向非关节节点的通道被忽略。
+// 只导入带 JOINTS_0/WEIGHTS_0 的三角形图元，且必须绑定在该 skin 上。
+// 二进制数据通过文件映射直接读取，不会按元素分配内存。
+[[nodiscard]] bool import_gltf(const std::string& path, GltfAsset& out);
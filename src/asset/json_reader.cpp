@@ -0,0 +1,425 @@
+#include "json_reader.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr int MAX_MANTISSA_DIGITS = 19;
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void append_utf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+}
+
+} // namespace
+
+JsonReader::JsonReader(const char* data, size_t size)
+    : _begin{data}, _cursor{data}, _end{data + size}, _error{nullptr},
+      _after_value{false} {}
+
+bool JsonReader::fail(const char* message) {
+    if (!_error) {
+        _error = message;
+    }
+    // 停在末尾，之后的调用都会立即失败。
+    _cursor = _end;
+    return false;
+}
+
+void JsonReader::skip_whitespace() {
+    while (_cursor < _end && (*_cursor == ' ' || *_cursor == '\n' ||
+                              *_cursor == '\r' || *_cursor == '\t')) {
+        ++_cursor;
+    }
+}
+
+bool JsonReader::expect(char c) {
+    skip_whitespace();
+    if (_cursor == _end || *_cursor != c) {
+        return fail("unexpected character");
+    }
+    ++_cursor;
+    return true;
+}
+
+bool JsonReader::separator(char close) {
+    if (failed()) {
+        return false;
+    }
+
+    skip_whitespace();
+    if (_cursor == _end) {
+        return fail("unexpected end of input");
+    }
+    if (*_cursor == close) {
+        ++_cursor;
+        _after_value = true;
+        return false;
+    }
+    if (_after_value) {
+        if (*_cursor != ',') {
+            return fail("expected ','");
+        }
+        ++_cursor;
+        _after_value = false;
+    }
+    return true;
+}
+
+bool JsonReader::begin_object() {
+    if (failed() || !expect('{')) {
+        return false;
+    }
+    _after_value = false;
+    return true;
+}
+
+bool JsonReader::begin_array() {
+    if (failed() || !expect('[')) {
+        return false;
+    }
+    _after_value = false;
+    return true;
+}
+
+bool JsonReader::next_key(std::string_view& key) {
+    if (!separator('}')) {
+        return false;
+    }
+
+    const char* begin;
+    const char* end;
+    if (!scan_string(begin, end) || !expect(':')) {
+        return false;
+    }
+    key = std::string_view(begin, static_cast<size_t>(end - begin));
+    _after_value = false;
+    return true;
+}
+
+bool JsonReader::next_element() { return separator(']'); }
+
+bool JsonReader::scan_string(const char*& begin, const char*& end) {
+    skip_whitespace();
+    if (_cursor == _end || *_cursor != '"') {
+        return fail("expected string");
+    }
+
+    begin = ++_cursor;
+    const void* quote;
+    // 先用 memchr 跳到下一个引号，只有碰到转义时才回头检查。
+    while ((quote = std::memchr(_cursor, '"',
+                                static_cast<size_t>(_end - _cursor)))) {
+        const char* q = static_cast<const char*>(quote);
+        size_t backslashes = 0;
+        while (q - backslashes > begin && q[-1 - backslashes] == '\\') {
+            ++backslashes;
+        }
+        _cursor = q + 1;
+        if (backslashes % 2 == 0) {
+            end = q;
+            return true;
+        }
+    }
+    return fail("unterminated string");
+}
+
+bool JsonReader::read_string(std::string& out) {
+    const char* begin;
+    const char* end;
+    if (failed() || !scan_string(begin, end)) {
+        return false;
+    }
+    _after_value = true;
+
+    out.clear();
+    for (const char* c = begin; c < end; ++c) {
+        if (*c != '\\') {
+            out.push_back(*c);
+            continue;
+        }
+
+        if (++c == end) {
+            return fail("invalid escape");
+        }
+        switch (*c) {
+            case '"':
+            case '\\':
+            case '/':
+                out.push_back(*c);
+                break;
+            case 'b':
+                out.push_back('\b');
+                break;
+            case 'f':
+                out.push_back('\f');
+                break;
+            case 'n':
+                out.push_back('\n');
+                break;
+            case 'r':
+                out.push_back('\r');
+                break;
+            case 't':
+                out.push_back('\t');
+                break;
+            case 'u': {
+                uint32_t code = 0;
+                for (int i = 0; i < 4; ++i) {
+                    int value = ++c < end ? hex_value(*c) : -1;
+                    if (value < 0) {
+                        return fail("invalid unicode escape");
+                    }
+                    code = code << 4 | static_cast<uint32_t>(value);
+                }
+                // 代理对：高位后面紧跟 \uDC00-\uDFFF。
+                if (code >= 0xd800 && code < 0xdc00 && end - c > 6 &&
+                    c[1] == '\\' && c[2] == 'u') {
+                    uint32_t low = 0;
+                    bool valid = true;
+                    for (int i = 3; i < 7 && valid; ++i) {
+                        int value = hex_value(c[i]);
+                        valid = value >= 0;
+                        low = low << 4 | static_cast<uint32_t>(value);
+                    }
+                    if (valid && low >= 0xdc00 && low < 0xe000) {
+                        code = 0x10000 + ((code - 0xd800) << 10) +
+                               (low - 0xdc00);
+                        c += 6;
+                    }
+                }
+                append_utf8(out, code);
+                break;
+            }
+            default:
+                return fail("invalid escape");
+        }
+    }
+    return true;
+}
+
+bool JsonReader::read_number(double& out) {
+    if (failed()) {
+        return false;
+    }
+
+    // 自己解析而不用 strtod：映射的文件没有结尾的 '\0'，
+    // 也不受 locale 的小数点设置影响。
+    skip_whitespace();
+    bool negative = _cursor < _end && *_cursor == '-';
+    if (negative) {
+        ++_cursor;
+    }
+    if (_cursor == _end || !is_digit(*_cursor)) {
+        return fail("expected number");
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    for (; _cursor < _end && is_digit(*_cursor); ++_cursor) {
+        if (digits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*_cursor - '0');
+            digits += mantissa > 0 ? 1 : 0;
+        } else {
+            ++exponent;
+        }
+    }
+
+    if (_cursor < _end && *_cursor == '.') {
+        ++_cursor;
+        if (_cursor == _end || !is_digit(*_cursor)) {
+            return fail("invalid number");
+        }
+        for (; _cursor < _end && is_digit(*_cursor); ++_cursor) {
+            if (digits < MAX_MANTISSA_DIGITS) {
+                mantissa =
+                    mantissa * 10 + static_cast<uint64_t>(*_cursor - '0');
+                digits += mantissa > 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+
+    if (_cursor < _end && (*_cursor == 'e' || *_cursor == 'E')) {
+        ++_cursor;
+        bool negative_exponent = false;
+        if (_cursor < _end && (*_cursor == '+' || *_cursor == '-')) {
+            negative_exponent = *_cursor == '-';
+            ++_cursor;
+        }
+        if (_cursor == _end || !is_digit(*_cursor)) {
+            return fail("invalid number");
+        }
+        int value = 0;
+        for (; _cursor < _end && is_digit(*_cursor); ++_cursor) {
+            if (value < 10000) {
+                value = value * 10 + (*_cursor - '0');
+            }
+        }
+        exponent += negative_exponent ? -value : value;
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (exponent != 0 && mantissa != 0) {
+        result *= std::pow(10.0, exponent);
+    }
+    out = negative ? -result : result;
+    _after_value = true;
+    return true;
+}
+
+bool JsonReader::read_float(float& out) {
+    double value;
+    if (!read_number(value)) {
+        return false;
+    }
+    out = static_cast<float>(value);
+    return true;
+}
+
+bool JsonReader::read_int(int& out) {
+    double value;
+    if (!read_number(value)) {
+        return false;
+    }
+    if (value != std::floor(value) || value < -2147483648.0 ||
+        value > 2147483647.0) {
+        return fail("expected integer");
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+bool JsonReader::read_uint64(uint64_t& out) {
+    double value;
+    if (!read_number(value)) {
+        return false;
+    }
+    if (value != std::floor(value) || value < 0.0 || value > 9.0e15) {
+        return fail("expected unsigned integer");
+    }
+    out = static_cast<uint64_t>(value);
+    return true;
+}
+
+bool JsonReader::read_bool(bool& out) {
+    if (failed()) {
+        return false;
+    }
+
+    skip_whitespace();
+    if (skip_literal("true", 4)) {
+        out = true;
+    } else if (skip_literal("false", 5)) {
+        out = false;
+    } else {
+        return fail("expected boolean");
+    }
+    _after_value = true;
+    return true;
+}
+
+bool JsonReader::skip_literal(const char* literal, size_t size) {
+    if (static_cast<size_t>(_end - _cursor) < size ||
+        std::memcmp(_cursor, literal, size) != 0) {
+        return false;
+    }
+    _cursor += size;
+    return true;
+}
+
+bool JsonReader::skip() {
+    if (failed()) {
+        return false;
+    }
+
+    skip_whitespace();
+    if (_cursor == _end) {
+        return fail("unexpected end of input");
+    }
+
+    switch (*_cursor) {
+        case '"': {
+            const char* begin;
+            const char* end;
+            if (!scan_string(begin, end)) {
+                return false;
+            }
+            break;
+        }
+        case '{':
+        case '[': {
+            // 只数括号深度，字符串整段跳过，以免里面的括号干扰计数。
+            int depth = 0;
+            do {
+                skip_whitespace();
+                if (_cursor == _end) {
+                    return fail("unexpected end of input");
+                }
+                char c = *_cursor;
+                if (c == '"') {
+                    const char* begin;
+                    const char* end;
+                    if (!scan_string(begin, end)) {
+                        return false;
+                    }
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ']') {
+                    --depth;
+                }
+                ++_cursor;
+            } while (depth > 0);
+            break;
+        }
+        case 't':
+        case 'f': {
+            bool value;
+            return read_bool(value);
+        }
+        case 'n':
+            if (!skip_literal("null", 4)) {
+                return fail("invalid literal");
+            }
+            break;
+        default: {
+            double value;
+            return read_number(value);
+        }
+    }
+
+    _after_value = true;
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 拉取式 JSON 读取器：直接在原始文本上前进，不建 DOM，除调用方传入的字符串外
+// 不分配内存。用法是按文档结构逐层调用：
+//
+//     reader.begin_object();
+//     std::string_view key;
+//     while (reader.next_key(key)) {
+//         if (key == "count") reader.read_number(count);
+//         else reader.skip();
+//     }
+//
+// 出错后所有调用都返回 false，外层循环会自然结束，最后检查 failed() 即可。
+class JsonReader {
+public:
+    JsonReader(const char* data, size_t size);
+
+    bool begin_object();
+    bool begin_array();
+    // 读到 '}' 时返回 false。键直接指向原文，不处理转义。
+    bool next_key(std::string_view& key);
+    // 读到 ']' 时返回 false。
+    bool next_element();
+
+    bool read_string(std::string& out);
+    bool read_number(double& out);
+    bool read_float(float& out);
+    bool read_int(int& out);
+    bool read_uint64(uint64_t& out);
+    bool read_bool(bool& out);
+    // 跳过一个完整的值，嵌套对象和数组不递归。
+    bool skip();
+
+    bool failed() const { return _error != nullptr; }
+    const char* error() const { return _error ? _error : ""; }
+    size_t offset() const { return static_cast<size_t>(_cursor - _begin); }
+
+private:
+    bool fail(const char* message);
+    void skip_whitespace();
+    bool expect(char c);
+    bool separator(char close);
+    bool scan_string(const char*& begin, const char*& end);
+    bool skip_literal(const char* literal, size_t size);
+
+    const char* _begin;
+    const char* _cursor;
+    const char* _end;
+    const char* _error;
+    // 刚读完一个值时为 true，此时下一个元素或键前必须有逗号。
+    bool _after_value;
+};
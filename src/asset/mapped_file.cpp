@@ -0,0 +1,145 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : _data{nullptr}, _size{0}, _file{nullptr}, _mapping{nullptr} {}
+
+#else
+
+MappedFile::MappedFile() : _data{nullptr}, _size{0} {}
+
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile() {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    close();
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+#ifdef _WIN32
+    std::swap(_file, other._file);
+    std::swap(_mapping, other._mapping);
+#endif
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::error("open file failed: {}", path);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        spdlog::error("empty or unreadable file: {}", path);
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        spdlog::error("create file mapping failed: {}", path);
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        spdlog::error("map view of file failed: {}", path);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    _data = static_cast<const uint8_t*>(view);
+    _size = static_cast<size_t>(size.QuadPart);
+    _file = file;
+    _mapping = mapping;
+    return true;
+}
+
+void MappedFile::close() {
+    if (_data) {
+        UnmapViewOfFile(_data);
+        CloseHandle(static_cast<HANDLE>(_mapping));
+        CloseHandle(static_cast<HANDLE>(_file));
+    }
+    _data = nullptr;
+    _size = 0;
+    _file = nullptr;
+    _mapping = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        spdlog::error("open file failed: {}", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        spdlog::error("empty or unreadable file: {}", path);
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                      MAP_PRIVATE, fd, 0);
+    // 映射建立后文件描述符就不再需要了。
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        spdlog::error("mmap failed: {}", path);
+        return false;
+    }
+
+    _data = static_cast<const uint8_t*>(view);
+    _size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (_data) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+    _data = nullptr;
+    _size = 0;
+}
+
+#endif
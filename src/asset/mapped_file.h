@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读映射整个文件，页面由系统按需载入，析构时解除映射。
+class MappedFile final {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return _data != nullptr; }
+    const uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    const uint8_t* _data;
+    size_t _size;
+#ifdef _WIN32
+    void* _file;
+    void* _mapping;
+#endif
+};
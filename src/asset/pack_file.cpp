@@ -0,0 +1,317 @@
+#include "pack_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+#include <spdlog/spdlog.h>
+
+#include "../core/hash.h"
+#include "../core/job_system.h"
+#include "../core/lz.h"
+
+namespace {
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool in_range(uint64_t offset, uint64_t size, uint64_t limit) {
+    return offset <= limit && size <= limit - offset;
+}
+
+uint64_t name_hash(const std::string& name) {
+    return fnv1a64(name.data(), name.size());
+}
+
+uint64_t header_checksum(const uint8_t* data, const PackHeader& header) {
+    PackHeader copy = header;
+    copy.header_checksum = 0;
+    uint64_t hash = fnv1a64(&copy, sizeof(copy));
+    hash = fnv1a64(data + header.index_offset,
+                   sizeof(PackEntry) * header.num_entries, hash);
+    return fnv1a64(data + header.string_table_offset,
+                   header.string_table_size, hash);
+}
+
+} // namespace
+
+bool PackWriter::add(const std::string& name, std::vector<uint8_t> data) {
+    for (const Entry& entry : _entries) {
+        if (entry.name == name) {
+            spdlog::error("duplicate pack entry: {}", name);
+            return false;
+        }
+    }
+    _entries.push_back(Entry{name, std::move(data)});
+    return true;
+}
+
+void PackWriter::build(std::vector<uint8_t>& out, JobSystem* jobs,
+                       PackCompression compression) const {
+    // 数据和索引用同一顺序，按顺序解压时读取也是顺序的。
+    uint32_t count = static_cast<uint32_t>(_entries.size());
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::vector<uint64_t> hashes(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        hashes[i] = name_hash(_entries[i].name);
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (hashes[a] != hashes[b]) {
+            return hashes[a] < hashes[b];
+        }
+        return _entries[a].name < _entries[b].name;
+    });
+
+    std::vector<std::vector<uint8_t>> packed(count);
+    auto compress = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const std::vector<uint8_t>& data = _entries[order[i]].data;
+            if (compression != PackCompression::Lz || data.empty()) {
+                continue;
+            }
+            std::vector<uint8_t> buffer(lz_compress_bound(data.size()));
+            size_t size = lz_compress(data.data(), data.size(), buffer.data());
+            // 至少省下 1/16 才值得在加载时解压，否则原样存放以便原地读取。
+            if (size < data.size() - data.size() / 16) {
+                buffer.resize(size);
+                packed[i] = std::move(buffer);
+            }
+        }
+    };
+    if (jobs) {
+        jobs->parallel_for(count, 1, compress);
+    } else {
+        compress(0, count);
+    }
+
+    std::vector<PackEntry> index(count);
+    std::string strings;
+    size_t offset = sizeof(PackHeader);
+    for (uint32_t i = 0; i < count; ++i) {
+        const Entry& entry = _entries[order[i]];
+        const std::vector<uint8_t>& stored =
+            packed[i].empty() ? entry.data : packed[i];
+
+        offset = align_up(offset, ASSET_ALIGNMENT);
+        index[i].name_hash = hashes[order[i]];
+        index[i].offset = offset;
+        index[i].stored_size = stored.size();
+        index[i].size = entry.data.size();
+        index[i].checksum = fnv1a64(stored.data(), stored.size());
+        index[i].name_offset = static_cast<uint32_t>(strings.size());
+        index[i].compression = static_cast<uint32_t>(
+            packed[i].empty() ? PackCompression::None : PackCompression::Lz);
+        strings.append(entry.name);
+        strings.push_back('\0');
+        offset += stored.size();
+    }
+
+    PackHeader header{};
+    header.magic = PACK_MAGIC;
+    header.version = PACK_VERSION;
+    header.num_entries = count;
+    header.index_offset = align_up(offset, alignof(PackEntry));
+    header.string_table_offset =
+        header.index_offset + sizeof(PackEntry) * index.size();
+    header.string_table_size = static_cast<uint32_t>(strings.size());
+    header.file_size = header.string_table_offset + strings.size();
+
+    out.assign(header.file_size, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        const std::vector<uint8_t>& stored =
+            packed[i].empty() ? _entries[order[i]].data : packed[i];
+        if (!stored.empty()) {
+            std::memcpy(out.data() + index[i].offset, stored.data(),
+                        stored.size());
+        }
+    }
+    if (!index.empty()) {
+        std::memcpy(out.data() + header.index_offset, index.data(),
+                    sizeof(PackEntry) * index.size());
+    }
+    std::memcpy(out.data() + header.string_table_offset, strings.data(),
+                strings.size());
+
+    header.header_checksum = header_checksum(out.data(), header);
+    std::memcpy(out.data(), &header, sizeof(header));
+}
+
+bool PackWriter::write(const std::string& path, JobSystem* jobs,
+                       PackCompression compression) const {
+    std::vector<uint8_t> data;
+    build(data, jobs, compression);
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        spdlog::error("open pack file for writing failed: {}", path);
+        return false;
+    }
+
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        spdlog::error("write pack file failed: {}", path);
+    }
+    return ok;
+}
+
+PackFile::PackFile() : _data{nullptr}, _size{0}, _header{nullptr} {}
+
+bool PackFile::open(const std::string& path) {
+    close();
+
+    if (!_file.open(path)) {
+        return false;
+    }
+
+    _data = _file.data();
+    _size = _file.size();
+    _header = reinterpret_cast<const PackHeader*>(_data);
+    if (!validate()) {
+        spdlog::error("invalid pack file: {}", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PackFile::close() {
+    _file.close();
+    _data = nullptr;
+    _size = 0;
+    _header = nullptr;
+}
+
+const char* PackFile::entry_name(unsigned int index) const {
+    return reinterpret_cast<const char*>(_data + _header->string_table_offset +
+                                         entries()[index].name_offset);
+}
+
+int PackFile::find(const std::string& name) const {
+    if (!_header) {
+        return -1;
+    }
+
+    uint64_t hash = name_hash(name);
+    const PackEntry* first = entries();
+    const PackEntry* last = first + _header->num_entries;
+    const PackEntry* it = std::lower_bound(
+        first, last, hash,
+        [](const PackEntry& entry, uint64_t value) {
+            return entry.name_hash < value;
+        });
+
+    // 哈希碰撞的条目相邻存放，逐个比较名字。
+    for (; it != last && it->name_hash == hash; ++it) {
+        unsigned int index = static_cast<unsigned int>(it - first);
+        if (name == entry_name(index)) {
+            return static_cast<int>(index);
+        }
+    }
+    return -1;
+}
+
+const uint8_t* PackFile::data(unsigned int index) const {
+    const PackEntry& e = entry(index);
+    if (e.compression != static_cast<uint32_t>(PackCompression::None)) {
+        return nullptr;
+    }
+    return _data + e.offset;
+}
+
+bool PackFile::extract(unsigned int index, void* destination) const {
+    const PackEntry& e = entry(index);
+    const uint8_t* stored = _data + e.offset;
+    if (fnv1a64(stored, e.stored_size) != e.checksum) {
+        spdlog::error("pack entry {} checksum mismatch.", entry_name(index));
+        return false;
+    }
+
+    switch (static_cast<PackCompression>(e.compression)) {
+        case PackCompression::None:
+            std::memcpy(destination, stored, e.size);
+            return true;
+        case PackCompression::Lz:
+            if (lz_decompress(stored, e.stored_size, destination, e.size)) {
+                return true;
+            }
+            break;
+    }
+    spdlog::error("pack entry {} is corrupt.", entry_name(index));
+    return false;
+}
+
+bool PackFile::extract(Span<PackExtract> requests, JobSystem& jobs) const {
+    // 小条目很多时每个任务多解压几个，减少派发的开销。
+    uint32_t count = static_cast<uint32_t>(requests.size());
+    uint32_t grain = std::max(1u, count / (jobs.num_threads() * 4));
+    jobs.parallel_for(count, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            requests[i].ok = extract(requests[i].entry,
+                                     requests[i].destination);
+        }
+    });
+
+    return std::all_of(requests.begin(), requests.end(),
+                       [](const PackExtract& r) { return r.ok; });
+}
+
+bool PackFile::validate() const {
+    if (_size < sizeof(PackHeader) ||
+        reinterpret_cast<uintptr_t>(_data) % alignof(PackHeader) != 0) {
+        return false;
+    }
+
+    const PackHeader& header = *_header;
+    if (header.magic != PACK_MAGIC) {
+        return false;
+    }
+    if (header.version != PACK_VERSION) {
+        spdlog::error("pack version {} unsupported, expected {}.",
+                      header.version, PACK_VERSION);
+        return false;
+    }
+    if (header.file_size != _size ||
+        !in_range(header.index_offset,
+                  static_cast<uint64_t>(sizeof(PackEntry)) *
+                      header.num_entries,
+                  _size) ||
+        header.index_offset % alignof(PackEntry) != 0 ||
+        !in_range(header.string_table_offset, header.string_table_size,
+                  _size)) {
+        return false;
+    }
+
+    if (header_checksum(_data, header) != header.header_checksum) {
+        spdlog::error("pack header checksum mismatch.");
+        return false;
+    }
+
+    const char* strings =
+        reinterpret_cast<const char*>(_data + header.string_table_offset);
+    if (header.string_table_size > 0 &&
+        strings[header.string_table_size - 1] != '\0') {
+        return false;
+    }
+
+    // 二分查找依赖索引有序，这里一并检查。
+    for (unsigned int i = 0; i < header.num_entries; ++i) {
+        const PackEntry& e = entries()[i];
+        bool stored_ok =
+            e.compression == static_cast<uint32_t>(PackCompression::Lz) ||
+            (e.compression == static_cast<uint32_t>(PackCompression::None) &&
+             e.stored_size == e.size);
+        if (e.name_offset >= header.string_table_size ||
+            e.offset % ASSET_ALIGNMENT != 0 ||
+            !in_range(e.offset, e.stored_size, _size) || !stored_ok ||
+            (i > 0 && entries()[i - 1].name_hash > e.name_hash)) {
+            spdlog::error("pack entry {} is malformed.", i);
+            return false;
+        }
+    }
+
+    return true;
+}
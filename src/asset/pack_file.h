@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../core/span.h"
+#include "mapped_file.h"
+#include "pack_format.h"
+
+class JobSystem;
+
+struct PackExtract {
+    unsigned int entry;
+    // 至少 entry.size 字节。要当作资源文件使用时按 ASSET_ALIGNMENT 对齐。
+    void* destination;
+    bool ok;
+};
+
+class PackWriter {
+public:
+    // 名字重复时返回 false。
+    bool add(const std::string& name, std::vector<uint8_t> data);
+
+    // jobs 不为空时各条目并行压缩。
+    void build(std::vector<uint8_t>& out, JobSystem* jobs,
+               PackCompression compression = PackCompression::Lz) const;
+    [[nodiscard]] bool write(const std::string& path, JobSystem* jobs,
+                             PackCompression compression =
+                                 PackCompression::Lz) const;
+
+private:
+    struct Entry {
+        std::string name;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<Entry> _entries;
+};
+
+// 映射整个资源包，打开时只校验文件头、索引和字符串表，条目内容在读取时校验。
+class PackFile final {
+public:
+    PackFile();
+    PackFile(const PackFile&) = delete;
+    PackFile& operator=(const PackFile&) = delete;
+
+    [[nodiscard]] bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return _header != nullptr; }
+    unsigned int num_entries() const {
+        return _header ? _header->num_entries : 0;
+    }
+    const PackEntry& entry(unsigned int index) const {
+        return entries()[index];
+    }
+    const char* entry_name(unsigned int index) const;
+
+    // 按名字哈希二分查找，没有找到时返回 -1。
+    int find(const std::string& name) const;
+
+    // 未压缩条目在映射内存中的地址，不校验内容。压缩的条目返回空。
+    const uint8_t* data(unsigned int index) const;
+    // 校验存放的数据并解压到 destination，未压缩的条目直接拷贝。
+    [[nodiscard]] bool extract(unsigned int index, void* destination) const;
+    // 每个条目一个任务，在工作线程上直接解压到各自的目标，返回是否全部成功。
+    bool extract(Span<PackExtract> requests, JobSystem& jobs) const;
+
+private:
+    const PackEntry* entries() const {
+        return reinterpret_cast<const PackEntry*>(_data +
+                                                  _header->index_offset);
+    }
+
+    bool validate() const;
+
+    MappedFile _file;
+    const uint8_t* _data;
+    size_t _size;
+    const PackHeader* _header;
+};
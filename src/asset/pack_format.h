@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include "asset_format.h"
+
+// 资源包的磁盘布局，把许多资源文件合并成一个，省掉逐个打开文件的开销。
+// 偏移都相对于文件开头，按小端序写入。
+//
+//   PackHeader
+//   各条目数据，起始地址按 ASSET_ALIGNMENT 对齐
+//   PackEntry[num_entries]，按 name_hash 升序排列，哈希相同时按名字排列
+//   字符串表（以 0 结尾的名字首尾相接）
+//
+// 未压缩的条目映射进内存后可以原地当作资源文件使用。
+constexpr uint32_t PACK_MAGIC = 0x4b415041; // "APAK"
+constexpr uint32_t PACK_VERSION = 1;
+
+enum class PackCompression : uint32_t {
+    None = 0,
+    Lz = 1,
+};
+
+struct PackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t file_size;
+    uint32_t num_entries;
+    uint32_t string_table_size;
+    uint64_t index_offset;
+    uint64_t string_table_offset;
+    // 覆盖文件头（此字段按 0 计算）、索引和字符串表，打开时总会校验。
+    uint64_t header_checksum;
+};
+
+struct PackEntry {
+    // 名字的 fnv1a64。
+    uint64_t name_hash;
+    uint64_t offset;
+    // 包内存放的字节数，未压缩时等于 size。
+    uint64_t stored_size;
+    uint64_t size;
+    // 存放数据的校验和，解压前计算。
+    uint64_t checksum;
+    uint32_t name_offset;
+    uint32_t compression;
+};
+
+static_assert(sizeof(PackHeader) == 48, "pack header layout changed");
+static_assert(sizeof(PackEntry) == 48, "pack entry layout changed");
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "../math/vec2.h"
+#include "../math/vec3.h"
+#include "../math/vec4.h"
+
+// 导入和写资源时使用的蒙皮网格，运行时直接读取映射内存中的 SkinnedMeshView。
+struct SkinnedMeshData {
+    std::vector<Vec3> positions;
+    std::vector<Vec3> normals;
+    std::vector<Vec2> uvs;
+    std::vector<std::array<uint16_t, 4>> joints;
+    std::vector<Vec4> weights;
+    std::vector<uint32_t> indices;
+};
@@ -0,0 +1,163 @@
+#include "alloc_tracker.h"
+
+#include <cstdlib>
+#include <new>
+
+#include <spdlog/spdlog.h>
+
+#include "log.h"
+
+namespace {
+
+std::atomic<uint64_t> g_frame_count{0};
+std::atomic<uint64_t> g_frame_bytes{0};
+
+thread_local AllocStats t_thread_stats;
+thread_local NoAllocScope* t_scope = nullptr;
+
+} // namespace
+
+std::atomic<bool> AllocTracker::_armed{false};
+std::atomic<bool> AllocTracker::_assert{false};
+
+void AllocTracker::record(size_t size) {
+    g_frame_count.fetch_add(1, std::memory_order_relaxed);
+    g_frame_bytes.fetch_add(size, std::memory_order_relaxed);
+    ++t_thread_stats.count;
+    t_thread_stats.bytes += size;
+    for (NoAllocScope* scope = t_scope; scope; scope = scope->_outer) {
+        scope->_count.fetch_add(1, std::memory_order_relaxed);
+        scope->_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+NoAllocScope* AllocTracker::scope() { return t_scope; }
+
+NoAllocScope* AllocTracker::set_scope(NoAllocScope* scope) {
+    NoAllocScope* previous = t_scope;
+    t_scope = scope;
+    return previous;
+}
+
+AllocStats AllocTracker::end_frame() {
+    AllocStats stats;
+    stats.count = g_frame_count.exchange(0, std::memory_order_relaxed);
+    stats.bytes = g_frame_bytes.exchange(0, std::memory_order_relaxed);
+    return stats;
+}
+
+AllocStats AllocTracker::thread_stats() { return t_thread_stats; }
+
+NoAllocScope::NoAllocScope(const char* name)
+    : _name{name}, _outer{AllocTracker::set_scope(this)}, _count{0},
+      _bytes{0} {}
+
+NoAllocScope::~NoAllocScope() {
+    AllocTracker::set_scope(_outer);
+    uint64_t count = _count.load(std::memory_order_relaxed);
+    uint64_t bytes = _bytes.load(std::memory_order_relaxed);
+    if (count == 0 || !AllocTracker::armed()) {
+        return;
+    }
+
+    if (AllocTracker::assert_enabled()) {
+        spdlog::critical("{} allocations ({} bytes) inside no-alloc scope {}.",
+                         count, bytes, _name);
+        // 异步 logger 的队列要先清空，否则这条消息可能来不及输出。
+        shutdown_logging();
+        std::abort();
+    }
+
+    ANIM_LOG_RATE_LIMITED(spdlog::level::err, 1000,
+                          "{} allocations ({} bytes) inside no-alloc scope {}.",
+                          count, bytes, _name);
+}
+
+#ifdef ANIM_TRACK_ALLOCATIONS
+
+namespace {
+
+void* tracked_alloc(size_t size) {
+    AllocTracker::record(size);
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* tracked_alloc(size_t size, std::align_val_t alignment) {
+    AllocTracker::record(size);
+    size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+    void* p = _aligned_malloc(size > 0 ? size : 1, align);
+#else
+    // aligned_alloc 要求大小是对齐的整数倍。
+    size_t rounded = (size + align - 1) / align * align;
+    void* p = std::aligned_alloc(align, rounded > 0 ? rounded : align);
+#endif
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void tracked_free(void* p) { std::free(p); }
+
+void tracked_free(void* p, std::align_val_t) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+void* operator new(size_t size) { return tracked_alloc(size); }
+void* operator new[](size_t size) { return tracked_alloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return tracked_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return tracked_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+    return tracked_alloc(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return tracked_alloc(size, alignment);
+}
+
+void operator delete(void* p) noexcept { tracked_free(p); }
+void operator delete[](void* p) noexcept { tracked_free(p); }
+void operator delete(void* p, size_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, size_t) noexcept { tracked_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    tracked_free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    tracked_free(p);
+}
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+    tracked_free(p, alignment);
+}
+void operator delete[](void* p, std::align_val_t alignment) noexcept {
+    tracked_free(p, alignment);
+}
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept {
+    tracked_free(p, alignment);
+}
+void operator delete[](void* p, size_t, std::align_val_t alignment) noexcept {
+    tracked_free(p, alignment);
+}
+
+#endif
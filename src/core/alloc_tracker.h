@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "profiler.h"
+
+// 打开 ANIM_TRACK_ALLOCATIONS 后替换全局 operator new/delete，统计每帧和每个
+// 线程的分配次数。ANIM_NO_ALLOC_SCOPE 标记的作用域在结束时检查其中
+// 是否分配过，作用域里提交的任务会带上它，在工作线程上的分配也算在内；
+// 等待时顺手执行的无关任务不算。未打开时宏不产生任何代码。
+#ifdef ANIM_TRACK_ALLOCATIONS
+#define ANIM_NO_ALLOC_SCOPE(name)                                              \
+    NoAllocScope ANIM_PROFILE_CONCAT(_no_alloc_scope_, __LINE__)(name)
+#else
+#define ANIM_NO_ALLOC_SCOPE(name) ((void)0)
+#endif
+
+class NoAllocScope;
+
+struct AllocStats {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+class AllocTracker final {
+public:
+    AllocTracker() = delete;
+
+    static constexpr bool enabled() {
+#ifdef ANIM_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // 预热阶段容器还在增长，armed 之前作用域检查不报告。
+    static void set_armed(bool armed) {
+        _armed.store(armed, std::memory_order_relaxed);
+    }
+    static bool armed() { return _armed.load(std::memory_order_relaxed); }
+
+    // 断言模式下违规直接终止，否则只记录错误日志。
+    static void set_assert(bool enabled) {
+        _assert.store(enabled, std::memory_order_relaxed);
+    }
+    static bool assert_enabled() {
+        return _assert.load(std::memory_order_relaxed);
+    }
+
+    static void record(size_t size);
+
+    // 当前线程所在的最内层 no-alloc 作用域，任务系统提交时记下，
+    // 执行时换上，返回之前的值以便恢复。
+    static NoAllocScope* scope();
+    static NoAllocScope* set_scope(NoAllocScope* scope);
+
+    // 返回自上次调用以来所有线程的分配并清零。
+    static AllocStats end_frame();
+    static AllocStats thread_stats();
+
+private:
+    static std::atomic<bool> _armed;
+    static std::atomic<bool> _assert;
+};
+
+// 作用域中提交的任务要在作用域结束前完成，通常是在作用域内 wait。
+class NoAllocScope final {
+public:
+    explicit NoAllocScope(const char* name);
+    ~NoAllocScope();
+
+    NoAllocScope(const NoAllocScope&) = delete;
+    NoAllocScope& operator=(const NoAllocScope&) = delete;
+
+private:
+    friend class AllocTracker;
+
+    const char* _name;
+    NoAllocScope* _outer;
+    // 多个线程上的任务可能同时计入同一个作用域。
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _bytes;
+};
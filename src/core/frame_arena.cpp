@@ -0,0 +1,82 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// 调试版把已释放的内存填成固定值，越界读到上一帧数据时一眼就能认出来。
+#ifndef NDEBUG
+constexpr uint8_t POISON_BYTE = 0xcd;
+#endif
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+FrameArena::FrameArena()
+    : _capacity{0}, _offset{0}, _high_watermark{0}, _overflow_count{0},
+      _overflow_bytes{0} {}
+
+void FrameArena::init(size_t capacity) {
+    _memory = std::make_unique<uint8_t[]>(capacity);
+    _capacity = capacity;
+    _offset.store(0, std::memory_order_relaxed);
+    _overflow_blocks.clear();
+    _overflow_bytes = 0;
+
+#ifndef NDEBUG
+    std::memset(_memory.get(), POISON_BYTE, _capacity);
+#endif
+}
+
+void FrameArena::reset() {
+    size_t used = std::min(_offset.load(std::memory_order_relaxed), _capacity);
+    size_t total = used + _overflow_bytes;
+    _high_watermark = std::max(_high_watermark, total);
+
+    if (!_overflow_blocks.empty()) {
+        // 本帧用量超过了容量，直接扩到峰值，下一帧起就不会再溢出。
+        size_t capacity = align_up(_high_watermark + _high_watermark / 4, 4096);
+        spdlog::warn("frame arena overflowed by {} bytes, growing to {} KB.",
+                     _overflow_bytes, capacity / 1024);
+        init(capacity);
+        return;
+    }
+
+#ifndef NDEBUG
+    std::memset(_memory.get(), POISON_BYTE, used);
+#endif
+    _offset.store(0, std::memory_order_relaxed);
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(_memory.get());
+    size_t offset = _offset.load(std::memory_order_relaxed);
+    while (true) {
+        size_t begin = align_up(base + offset, alignment) - base;
+        size_t end = begin + size;
+        if (end > _capacity) {
+            return allocate_overflow(size, alignment);
+        }
+        if (_offset.compare_exchange_weak(offset, end,
+                                          std::memory_order_relaxed)) {
+            return _memory.get() + begin;
+        }
+    }
+}
+
+void* FrameArena::allocate_overflow(size_t size, size_t alignment) {
+    std::lock_guard<std::mutex> lock(_overflow_mutex);
+    ++_overflow_count;
+    _overflow_bytes += size + alignment;
+
+    _overflow_blocks.push_back(std::make_unique<uint8_t[]>(size + alignment));
+    uintptr_t address =
+        reinterpret_cast<uintptr_t>(_overflow_blocks.back().get());
+    return reinterpret_cast<void*>(align_up(address, alignment));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// 每帧重置的线性分配器。分配只是一次原子加法，工作线程也可以直接使用；
+// 对象不会被析构，所以只能放平凡析构的类型。
+// 超出容量时临时向系统申请溢出块，重置时释放并把容量扩到本帧用量，
+// 稳定之后每帧都不会再调用全局分配器。
+class FrameArena final {
+public:
+    FrameArena();
+    ~FrameArena() = default;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena(FrameArena&&) = delete;
+
+    FrameArena& operator=(const FrameArena&) = delete;
+    FrameArena& operator=(FrameArena&&) = delete;
+
+    void init(size_t capacity);
+    void reset();
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* allocate_array(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "frame arena never runs destructors");
+        void* memory = allocate(sizeof(T) * count, alignof(T));
+        for (size_t i = 0; i < count; ++i) {
+            new (static_cast<T*>(memory) + i) T();
+        }
+        return static_cast<T*>(memory);
+    }
+
+    size_t capacity() const { return _capacity; }
+    size_t used() const { return _offset.load(std::memory_order_relaxed); }
+    size_t high_watermark() const { return _high_watermark; }
+    uint64_t overflow_count() const { return _overflow_count; }
+
+private:
+    void* allocate_overflow(size_t size, size_t alignment);
+
+    std::unique_ptr<uint8_t[]> _memory;
+    size_t _capacity;
+    std::atomic<size_t> _offset;
+
+    size_t _high_watermark;
+    uint64_t _overflow_count;
+
+    std::mutex _overflow_mutex;
+    std::vector<std::unique_ptr<uint8_t[]>> _overflow_blocks;
+    size_t _overflow_bytes;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr uint64_t FNV1A64_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV1A64_PRIME = 0x100000001b3ull;
+
+// 用于校验和与资源名哈希，不需要抗碰撞，只要快、稳定、跨平台一致。
+inline uint64_t fnv1a64(const void* data, size_t size,
+                        uint64_t hash = FNV1A64_OFFSET) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV1A64_PRIME;
+    }
+    return hash;
+}
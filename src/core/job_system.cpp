@@ -0,0 +1,333 @@
+#include "job_system.h"
+
+#include <string>
+
+#include "alloc_tracker.h"
+#include "log.h"
+#include "profiler.h"
+
+namespace {
+
+thread_local const JobSystem* t_owner = nullptr;
+thread_local unsigned int t_queue = 0;
+
+constexpr int SPIN_COUNT = 64;
+
+} // namespace
+
+JobSystem::JobSystem()
+    : _running{false}, _pending{0}, _sleeping{0}, _num_deferred{0} {}
+
+JobSystem::~JobSystem() { shutdown(); }
+
+bool JobSystem::init(unsigned int num_workers) {
+    if (_running) {
+        return true;
+    }
+
+    if (num_workers == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        num_workers = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    _queues.clear();
+    for (unsigned int i = 0; i < num_workers + 1; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    _background = std::make_unique<Queue>();
+    _deferred.reserve(MAX_DEFERRED_JOBS);
+
+    _running = true;
+    t_owner = this;
+    t_queue = 0;
+
+    for (unsigned int i = 1; i <= num_workers; ++i) {
+        _workers.emplace_back(&JobSystem::worker_main, this, i);
+    }
+
+    spdlog::info("job system started with {} workers.", num_workers);
+    return true;
+}
+
+void JobSystem::shutdown() {
+    if (!_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _running = false;
+    }
+    _wake.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+    _workers.clear();
+
+    // 正常退出时队列应为空，残留的任务在当前线程跑完。
+    Job job;
+    while (pop(0, job) || steal(0, job)) {
+        execute(job);
+    }
+    while (try_run_background()) {
+    }
+    _queues.clear();
+    _background.reset();
+}
+
+void JobSystem::run(const Job& job) {
+    if (job.counter) {
+        job.counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    dispatch(scoped(job));
+}
+
+Job JobSystem::scoped(const Job& job) {
+    // 后台任务可能比提交时的作用域活得久，不走这里。
+    Job result = job;
+    if (AllocTracker::enabled()) {
+        result.no_alloc_scope = AllocTracker::scope();
+    }
+    return result;
+}
+
+void JobSystem::dispatch(const Job& job) {
+    if (_queues.empty() || !push(current_queue(), job)) {
+        execute(job);
+        return;
+    }
+
+    _pending.fetch_add(1);
+    if (_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _wake.notify_one();
+    }
+}
+
+void JobSystem::run_background(const Job& job) {
+    if (job.counter) {
+        job.counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 不继承提交方的 no-alloc 作用域，见 scoped。
+    Job unscoped = job;
+    unscoped.no_alloc_scope = nullptr;
+
+    bool queued = false;
+    if (_background) {
+        Queue& q = *_background;
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.size < QUEUE_CAPACITY) {
+            q.jobs[(q.head + q.size) % QUEUE_CAPACITY] = unscoped;
+            ++q.size;
+            queued = true;
+        }
+    }
+    if (!queued) {
+        ANIM_LOG_RATE_LIMITED(spdlog::level::warn, 1000,
+                              "background queue full, running inline.");
+        execute(unscoped);
+        return;
+    }
+
+    _pending.fetch_add(1);
+    if (_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _wake.notify_one();
+    }
+}
+
+void JobSystem::run_after(JobCounter& dependency, const Job& job) {
+    if (dependency.done()) {
+        run(job);
+        return;
+    }
+
+    if (job.counter) {
+        job.counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool deferred = false;
+    {
+        std::lock_guard<std::mutex> lock(_deferred_mutex);
+        if (_deferred.size() < MAX_DEFERRED_JOBS) {
+            _deferred.emplace_back(&dependency, scoped(job));
+            _num_deferred.fetch_add(1);
+            deferred = true;
+        }
+    }
+
+    if (!deferred) {
+        ANIM_LOG_RATE_LIMITED(spdlog::level::warn, 1000,
+                              "too many deferred jobs, waiting inline.");
+        wait(dependency);
+        execute(scoped(job));
+        return;
+    }
+
+    // 依赖可能在入队前就已完成，这里再检查一次以免任务永远挂起。
+    release_deferred();
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    unsigned int index = current_queue();
+    int spins = 0;
+    while (!counter.done()) {
+        if (try_run_one(index)) {
+            spins = 0;
+        } else if (++spins > SPIN_COUNT) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::worker_main(unsigned int index) {
+    t_owner = this;
+    t_queue = index;
+
+    std::string name = "worker " + std::to_string(index);
+    Profiler::set_thread_name(name.c_str());
+
+    while (_running) {
+        bool found = false;
+        for (int spin = 0; spin < SPIN_COUNT && !found; ++spin) {
+            found = try_run_one(index);
+        }
+        // 帧内的任务都处理完了才去做后台任务。
+        if (!found) {
+            found = try_run_background();
+        }
+        if (found) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        _sleeping.fetch_add(1);
+        _wake.wait(lock, [this] { return _pending.load() > 0 || !_running; });
+        _sleeping.fetch_sub(1);
+    }
+}
+
+bool JobSystem::push(unsigned int queue, const Job& job) {
+    Queue& q = *_queues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.size == QUEUE_CAPACITY) {
+        return false;
+    }
+
+    q.jobs[(q.head + q.size) % QUEUE_CAPACITY] = job;
+    ++q.size;
+    return true;
+}
+
+bool JobSystem::pop(unsigned int queue, Job& job) {
+    Queue& q = *_queues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.size == 0) {
+        return false;
+    }
+
+    --q.size;
+    job = q.jobs[(q.head + q.size) % QUEUE_CAPACITY];
+    return true;
+}
+
+bool JobSystem::steal(unsigned int thief, Job& job) {
+    unsigned int count = static_cast<unsigned int>(_queues.size());
+    for (unsigned int i = 1; i < count; ++i) {
+        Queue& q = *_queues[(thief + i) % count];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.size == 0) {
+            continue;
+        }
+
+        job = q.jobs[q.head];
+        q.head = (q.head + 1) % QUEUE_CAPACITY;
+        --q.size;
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::try_run_one(unsigned int index) {
+    Job job;
+    if (!pop(index, job) && !steal(index, job)) {
+        return false;
+    }
+
+    _pending.fetch_sub(1);
+    execute(job);
+    return true;
+}
+
+bool JobSystem::try_run_background() {
+    Job job;
+    {
+        Queue& q = *_background;
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.size == 0) {
+            return false;
+        }
+        job = q.jobs[q.head];
+        q.head = (q.head + 1) % QUEUE_CAPACITY;
+        --q.size;
+    }
+
+    _pending.fetch_sub(1);
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(const Job& job) {
+    // 分配只算进提交任务时的作用域，等待时顺手执行的任务不算进等待方的。
+    NoAllocScope* outer = nullptr;
+    if (AllocTracker::enabled()) {
+        outer = AllocTracker::set_scope(job.no_alloc_scope);
+    }
+    {
+        ANIM_PROFILE_SCOPE("Job");
+        job.function(job.data, job.begin, job.end);
+    }
+    if (AllocTracker::enabled()) {
+        AllocTracker::set_scope(outer);
+    }
+
+    if (job.counter &&
+        job.counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+        _num_deferred.load() > 0) {
+        release_deferred();
+    }
+}
+
+void JobSystem::release_deferred() {
+    // 每次只摘下一个就绪任务并在锁外派发，派发时可能内联执行并再次进入这里。
+    for (;;) {
+        Job job;
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> lock(_deferred_mutex);
+            for (size_t i = 0; i < _deferred.size(); ++i) {
+                if (_deferred[i].first->done()) {
+                    job = _deferred[i].second;
+                    _deferred[i] = _deferred.back();
+                    _deferred.pop_back();
+                    _num_deferred.fetch_sub(1);
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found) {
+            return;
+        }
+
+        // 计数器在 run_after 时已经加过，这里直接入队。
+        dispatch(job);
+    }
+}
+
+unsigned int JobSystem::current_queue() const {
+    return t_owner == this ? t_queue : 0;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct JobCounter {
+    std::atomic<int> value{0};
+
+    bool done() const { return value.load(std::memory_order_acquire) == 0; }
+};
+
+class NoAllocScope;
+
+struct Job {
+    void (*function)(void* data, uint32_t begin, uint32_t end);
+    void* data;
+    uint32_t begin;
+    uint32_t end;
+    JobCounter* counter;
+    // 由 run / run_after 填入提交时所在的 no-alloc 作用域，调用方不用设置。
+    NoAllocScope* no_alloc_scope;
+};
+
+// 每个工作线程一个双端队列：自己从尾部取（LIFO），空闲时从别人头部偷（FIFO）。
+// 队列满时直接在提交线程执行，运行期不会分配内存。
+// 加载场景、解码资源这类耗时的任务走单独的后台队列，只有空闲的工作线程会取，
+// wait 帮忙执行时不会碰，等待方不会被拖进一个与自己无关的长任务。
+class JobSystem final {
+public:
+    JobSystem();
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    [[nodiscard]] bool init(unsigned int num_workers);
+    void shutdown();
+
+    unsigned int num_threads() const {
+        return static_cast<unsigned int>(_queues.size());
+    }
+
+    void run(const Job& job);
+    void run_after(JobCounter& dependency, const Job& job);
+    // 后台任务按提交顺序执行，可以用 counter 查询是否完成，
+    // 但不要在帧内 wait 它，那样只会原地空等。
+    void run_background(const Job& job);
+    void wait(JobCounter& counter);
+
+    template <typename F>
+    void parallel_for(uint32_t count, uint32_t grain, F&& fn);
+
+private:
+    static constexpr uint32_t QUEUE_CAPACITY = 4096;
+    static constexpr uint32_t MAX_DEFERRED_JOBS = 1024;
+
+    struct Queue {
+        std::mutex mutex;
+        Job jobs[QUEUE_CAPACITY];
+        uint32_t head = 0;
+        uint32_t size = 0;
+    };
+
+    void worker_main(unsigned int index);
+
+    bool push(unsigned int queue, const Job& job);
+    bool pop(unsigned int queue, Job& job);
+    bool steal(unsigned int thief, Job& job);
+    bool try_run_one(unsigned int index);
+    bool try_run_background();
+    static Job scoped(const Job& job);
+    void dispatch(const Job& job);
+    void execute(const Job& job);
+    void release_deferred();
+
+    unsigned int current_queue() const;
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::unique_ptr<Queue> _background;
+    std::vector<std::thread> _workers;
+
+    std::atomic<bool> _running;
+    std::atomic<int> _pending;
+    std::atomic<int> _sleeping;
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+
+    std::mutex _deferred_mutex;
+    std::vector<std::pair<JobCounter*, Job>> _deferred;
+    std::atomic<int> _num_deferred;
+};
+
+template <typename F>
+void JobSystem::parallel_for(uint32_t count, uint32_t grain, F&& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = grain > 0 ? grain : 1;
+
+    using Function = std::remove_reference_t<F>;
+    JobCounter counter;
+    Job job{};
+    job.function = [](void* data, uint32_t begin, uint32_t end) {
+        (*static_cast<Function*>(data))(begin, end);
+    };
+    job.data = const_cast<void*>(static_cast<const void*>(&fn));
+    job.counter = &counter;
+
+    for (uint32_t begin = 0; begin < count; begin += grain) {
+        job.begin = begin;
+        job.end = count - begin > grain ? begin + grain : count;
+        run(job);
+    }
+    wait(counter);
+}
@@ -0,0 +1,67 @@
+#include "log.h"
+
+#include <exception>
+#include <memory>
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+namespace {
+
+spdlog::async_overflow_policy to_spdlog(LogOverflow overflow) {
+    switch (overflow) {
+        case LogOverflow::Block:
+            return spdlog::async_overflow_policy::block;
+        case LogOverflow::DropOldest:
+            return spdlog::async_overflow_policy::overrun_oldest;
+        case LogOverflow::DropNewest:
+            return spdlog::async_overflow_policy::discard_new;
+    }
+    return spdlog::async_overflow_policy::block;
+}
+
+} // namespace
+
+bool init_logging(const LogSettings& settings) {
+    if (settings.async) {
+        try {
+            spdlog::init_thread_pool(settings.queue_size, 1);
+            auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+            auto logger = std::make_shared<spdlog::async_logger>(
+                "anim", sink, spdlog::thread_pool(),
+                to_spdlog(settings.overflow));
+            spdlog::set_default_logger(logger);
+        } catch (const std::exception& e) {
+            spdlog::error("async logger init failed: {}", e.what());
+            return false;
+        }
+    }
+
+#ifdef NDEBUG
+    spdlog::set_level(spdlog::level::info);
+#else
+    spdlog::set_level(spdlog::level::trace);
+#endif
+    // 警告以上立即刷出，崩溃前的最后几条不会留在队列里。
+    spdlog::flush_on(spdlog::level::warn);
+
+    return true;
+}
+
+void shutdown_logging() { spdlog::shutdown(); }
+
+LogRateLimiter::LogRateLimiter(uint64_t interval_ms)
+    : _interval{interval_ms * 1000000}, _next{0}, _suppressed{0} {}
+
+bool LogRateLimiter::allow(uint64_t& suppressed) {
+    uint64_t now = Profiler::now();
+    uint64_t next = _next.load(std::memory_order_relaxed);
+    if (now < next || !_next.compare_exchange_strong(
+                          next, now + _interval, std::memory_order_relaxed)) {
+        _suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
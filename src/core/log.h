@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <spdlog/spdlog.h>
+
+#include "profiler.h"
+
+// 同一调用点在 interval_ms 内只输出一次，期间被跳过的条数附在下一次输出后面。
+// 级别未启用时只有一次比较，不会格式化参数。
+#define ANIM_LOG_RATE_LIMITED(level, interval_ms, ...)                         \
+    do {                                                                       \
+        if (spdlog::should_log(level)) {                                       \
+            static LogRateLimiter ANIM_PROFILE_CONCAT(_log_limiter_,           \
+                                                      __LINE__)(interval_ms);  \
+            uint64_t _log_suppressed = 0;                                      \
+            if (ANIM_PROFILE_CONCAT(_log_limiter_, __LINE__)                   \
+                    .allow(_log_suppressed)) {                                 \
+                spdlog::log(level, __VA_ARGS__);                               \
+                if (_log_suppressed > 0) {                                     \
+                    spdlog::log(level, "  ({} similar messages suppressed)",   \
+                                _log_suppressed);                              \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+enum class LogOverflow {
+    // 队列满时调用线程等待，不丢日志。
+    Block,
+    // 覆盖最旧的一条，调用线程永不等待。
+    DropOldest,
+    // 丢弃新来的一条，调用线程永不等待。
+    DropNewest,
+};
+
+struct LogSettings {
+    bool async = true;
+    size_t queue_size = 8192;
+    LogOverflow overflow = LogOverflow::DropOldest;
+};
+
+// 把默认 logger 换成后台线程输出的异步 logger，
+// 程序退出前需要调用 shutdown_logging。
+[[nodiscard]] bool init_logging(const LogSettings& settings);
+void shutdown_logging();
+
+class LogRateLimiter final {
+public:
+    explicit LogRateLimiter(uint64_t interval_ms);
+
+    bool allow(uint64_t& suppressed);
+
+private:
+    uint64_t _interval;
+    std::atomic<uint64_t> _next;
+    std::atomic<uint64_t> _suppressed;
+};
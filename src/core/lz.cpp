@@ -0,0 +1,177 @@
+#include "lz.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_DISTANCE = 65535;
+constexpr unsigned int HASH_BITS = 16;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hash4(const uint8_t* p) {
+    return (read32(p) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+uint8_t* write_length(uint8_t* op, size_t length) {
+    for (; length >= 255; length -= 255) {
+        *op++ = 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+uint8_t* write_sequence(uint8_t* op, const uint8_t* literals,
+                        size_t num_literals, size_t distance,
+                        size_t match_length) {
+    size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>(
+        (num_literals < 15 ? num_literals : 15) << 4 |
+        (match_code < 15 ? match_code : 15));
+    if (num_literals >= 15) {
+        op = write_length(op, num_literals - 15);
+    }
+    if (num_literals > 0) {
+        std::memcpy(op, literals, num_literals);
+        op += num_literals;
+    }
+
+    if (match_length == 0) {
+        return op;
+    }
+    *op++ = static_cast<uint8_t>(distance);
+    *op++ = static_cast<uint8_t>(distance >> 8);
+    if (match_code >= 15) {
+        op = write_length(op, match_code - 15);
+    }
+    return op;
+}
+
+// 读取 15 之后的扩展长度，输入不够时返回 false。
+bool read_length(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip == end) {
+            return false;
+        }
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+size_t lz_compress_bound(size_t size) { return size + size / 255 + 16; }
+
+size_t lz_compress(const void* src, size_t size, void* dst) {
+    const auto* base = static_cast<const uint8_t*>(src);
+    const uint8_t* ip = base;
+    const uint8_t* end = base + size;
+    const uint8_t* anchor = base;
+    auto* out = static_cast<uint8_t*>(dst);
+    uint8_t* op = out;
+
+    // 记录每个 4 字节哈希最近出现的位置，贪心地取第一个可用的匹配。
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+    const uint8_t* match_limit = size >= MIN_MATCH ? end - MIN_MATCH : base;
+    while (ip < match_limit) {
+        uint32_t hash = hash4(ip);
+        const uint8_t* candidate = base + table[hash];
+        table[hash] = static_cast<uint32_t>(ip - base);
+
+        if (candidate >= ip || static_cast<size_t>(ip - candidate) >
+                                   MAX_DISTANCE ||
+            read32(candidate) != read32(ip)) {
+            ++ip;
+            continue;
+        }
+
+        size_t length = MIN_MATCH;
+        while (ip + length < end && candidate[length] == ip[length]) {
+            ++length;
+        }
+
+        op = write_sequence(op, anchor, static_cast<size_t>(ip - anchor),
+                            static_cast<size_t>(ip - candidate), length);
+        ip += length;
+        anchor = ip;
+    }
+
+    op = write_sequence(op, anchor, static_cast<size_t>(end - anchor), 0, 0);
+    return static_cast<size_t>(op - out);
+}
+
+bool lz_decompress(const void* src, size_t size, void* dst, size_t dst_size) {
+    const auto* ip = static_cast<const uint8_t*>(src);
+    const uint8_t* end = ip + size;
+    auto* out = static_cast<uint8_t*>(dst);
+    uint8_t* op = out;
+    uint8_t* out_end = out + dst_size;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t num_literals = token >> 4;
+        if (num_literals == 15 && !read_length(ip, end, num_literals)) {
+            return false;
+        }
+        if (num_literals > static_cast<size_t>(end - ip) ||
+            num_literals > static_cast<size_t>(out_end - op)) {
+            return false;
+        }
+        if (num_literals > 0) {
+            std::memcpy(op, ip, num_literals);
+            ip += num_literals;
+            op += num_literals;
+        }
+
+        // 最后一段只有字面量。
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t distance = ip[0] | static_cast<size_t>(ip[1]) << 8;
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15 && !read_length(ip, end, length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if (distance == 0 || distance > static_cast<size_t>(op - out) ||
+            length > static_cast<size_t>(out_end - op)) {
+            return false;
+        }
+
+        // 距离小于长度时源和目标重叠，要按距离分段向前展开，
+        // 距离不小于 8 时每次拷 8 字节也不会读到本次还没写的位置。
+        const uint8_t* match = op - distance;
+        if (distance >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        } else if (distance >= 8) {
+            uint8_t* copy_end = op + length;
+            for (; copy_end - op >= 8; op += 8, match += 8) {
+                std::memcpy(op, match, 8);
+            }
+            while (op < copy_end) {
+                *op++ = *match++;
+            }
+        } else {
+            for (size_t i = 0; i < length; ++i) {
+                *op++ = match[i];
+            }
+        }
+    }
+    return op == out_end;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+// 字节对齐的 LZ77 变体，格式与 LZ4 的块格式相近：每段是一个标记字节
+// （高 4 位字面量长度，低 4 位匹配长度减 4，取 15 时后续字节继续累加），
+// 接着是字面量、2 字节小端的回溯距离和扩展的匹配长度，最后一段只有字面量。
+// 解压只有拷贝和分支，速度接近内存带宽，适合在加载时做。
+
+// 最坏情况（完全不可压缩）下的输出大小。
+size_t lz_compress_bound(size_t size);
+// dst 至少要有 lz_compress_bound(size) 字节，返回压缩后的大小。
+size_t lz_compress(const void* src, size_t size, void* dst);
+// 解压结果必须恰好填满 dst_size，数据损坏时返回 false，不会越界读写。
+[[nodiscard]] bool lz_decompress(const void* src, size_t size, void* dst,
+                                 size_t dst_size);
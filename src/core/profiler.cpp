@@ -0,0 +1,218 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+constexpr uint32_t EVENTS_PER_THREAD = 1u << 15;
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// 导出时所属线程可能还在写，字段用 relaxed 原子读写，x86 上与普通读写相同。
+struct ProfileSlot {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> end{0};
+};
+
+struct ThreadEvents {
+    uint32_t id;
+    std::string name;
+    std::atomic<uint64_t> count{0};
+    std::unique_ptr<ProfileSlot[]> events;
+};
+
+struct ThreadRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadEvents>> threads;
+};
+
+ThreadRegistry& thread_registry() {
+    static ThreadRegistry registry;
+    return registry;
+}
+
+ThreadEvents& thread_events() {
+    thread_local std::shared_ptr<ThreadEvents> events = [] {
+        auto result = std::make_shared<ThreadEvents>();
+        result->events = std::make_unique<ProfileSlot[]>(EVENTS_PER_THREAD);
+
+        ThreadRegistry& registry = thread_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        result->id = static_cast<uint32_t>(registry.threads.size());
+        result->name = "thread " + std::to_string(result->id);
+        registry.threads.push_back(result);
+        return result;
+    }();
+    return *events;
+}
+
+void write_json_string(std::FILE* file, const char* text) {
+    std::fputc('"', file);
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+
+} // namespace
+
+std::atomic<bool> Profiler::_enabled{false};
+
+uint64_t Profiler::now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::now() - epoch;
+    // 0 表示“未开始”，所以时间戳从 1 纳秒算起。
+    return static_cast<uint64_t>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                   .count()) +
+           1;
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end) {
+    ThreadEvents& thread = thread_events();
+    uint64_t index = thread.count.load(std::memory_order_relaxed);
+    // 与导出时的 acquire 栅栏配对：导出方读到这次写入的任何字段，
+    // 之后再读 count 就至少是 index。
+    std::atomic_thread_fence(std::memory_order_release);
+    ProfileSlot& slot = thread.events[index % EVENTS_PER_THREAD];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    thread.count.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::set_thread_name(const char* name) {
+    ThreadEvents& thread = thread_events();
+    std::lock_guard<std::mutex> lock(thread_registry().mutex);
+    thread.name = name;
+}
+
+bool Profiler::write_chrome_trace(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        spdlog::error("open trace file failed: {}", path);
+        return false;
+    }
+
+    ThreadRegistry& registry = thread_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    size_t written = 0;
+    std::vector<ProfileEvent> events;
+    events.reserve(EVENTS_PER_THREAD);
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+    for (const std::shared_ptr<ThreadEvents>& thread : registry.threads) {
+        std::fprintf(file,
+                     "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                     "\"tid\":%u,\"args\":{\"name\":",
+                     written++ > 0 ? "," : "", thread->id);
+        write_json_string(file, thread->name.c_str());
+        std::fputs("}}", file);
+
+        // 所属线程还在记录，先复制整个环，再丢掉复制期间可能被覆盖的部分。
+        uint64_t count = thread->count.load(std::memory_order_acquire);
+        uint64_t first = count > EVENTS_PER_THREAD
+                             ? count - EVENTS_PER_THREAD
+                             : 0;
+        events.clear();
+        for (uint64_t i = first; i < count; ++i) {
+            const ProfileSlot& slot = thread->events[i % EVENTS_PER_THREAD];
+            events.push_back(ProfileEvent{
+                slot.name.load(std::memory_order_relaxed),
+                slot.start.load(std::memory_order_relaxed),
+                slot.end.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // 序号 count_after 的事件可能正写到一半，它占用的是
+        // count_after - EVENTS_PER_THREAD 的槽位，所以这一个也不要。
+        uint64_t count_after = thread->count.load(std::memory_order_relaxed);
+        uint64_t valid = count_after >= EVENTS_PER_THREAD
+                             ? count_after - EVENTS_PER_THREAD + 1
+                             : 0;
+        size_t skip = static_cast<size_t>(
+            std::min<uint64_t>(std::max(valid, first) - first, events.size()));
+
+        for (size_t i = skip; i < events.size(); ++i) {
+            const ProfileEvent& event = events[i];
+            std::fputs(",\n{\"name\":", file);
+            write_json_string(file, event.name);
+            std::fprintf(file,
+                         ",\"cat\":\"anim\",\"ph\":\"X\",\"pid\":1,"
+                         "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         thread->id, static_cast<double>(event.start) / 1e3,
+                         static_cast<double>(event.end - event.start) / 1e3);
+        }
+    }
+    std::fputs("\n]}\n", file);
+    std::fclose(file);
+
+    spdlog::info("wrote chrome trace: {}", path);
+    return true;
+}
+
+FrameStats::FrameStats(unsigned int interval)
+    : _interval{interval}, _count{0}, _sum{0.0}, _sum_sq{0.0}, _min{0.0f},
+      _max{0.0f}, _target{0.0f}, _max_deviation{0.0f} {}
+
+void FrameStats::add(float frame_time) {
+    if (_interval == 0) {
+        return;
+    }
+
+    if (_count == 0) {
+        _min = frame_time;
+        _max = frame_time;
+    }
+    _min = std::min(_min, frame_time);
+    _max = std::max(_max, frame_time);
+    _sum += frame_time;
+    _sum_sq += static_cast<double>(frame_time) * frame_time;
+    if (_target > 0.0f) {
+        _max_deviation =
+            std::max(_max_deviation, std::abs(frame_time - _target));
+    }
+
+    if (++_count >= _interval) {
+        flush();
+    }
+}
+
+void FrameStats::flush() {
+    double avg = _sum / _count;
+    // 帧时间的标准差作为抖动。
+    double jitter = std::sqrt(std::max(_sum_sq / _count - avg * avg, 0.0));
+    if (_target > 0.0f) {
+        spdlog::info("frame stats ({} frames): avg {:.3f} ms, min {:.3f} ms, "
+                     "max {:.3f} ms, jitter {:.3f} ms, "
+                     "max deviation from target {:.3f} ms.",
+                     _count, avg * 1000.0, _min * 1000.0f, _max * 1000.0f,
+                     jitter * 1000.0, _max_deviation * 1000.0f);
+    } else {
+        spdlog::info("frame stats ({} frames): avg {:.3f} ms, min {:.3f} ms, "
+                     "max {:.3f} ms, jitter {:.3f} ms.",
+                     _count, avg * 1000.0, _min * 1000.0f, _max * 1000.0f,
+                     jitter * 1000.0);
+    }
+
+    _count = 0;
+    _sum = 0.0;
+    _sum_sq = 0.0;
+    _max_deviation = 0.0f;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define ANIM_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ANIM_PROFILE_CONCAT(a, b) ANIM_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef ANIM_ENABLE_PROFILER
+#define ANIM_PROFILE_SCOPE(name)                                               \
+    ProfileScope ANIM_PROFILE_CONCAT(_profile_scope_, __LINE__)(name)
+#else
+#define ANIM_PROFILE_SCOPE(name) ((void)0)
+#endif
+
+// 每个线程一个环形缓冲区，只记录最近的事件；关闭时每个作用域只多一次原子读。
+class Profiler final {
+public:
+    Profiler() = delete;
+
+    static void set_enabled(bool enabled) {
+        _enabled.store(enabled, std::memory_order_relaxed);
+    }
+    static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    static uint64_t now();
+    static void record(const char* name, uint64_t start, uint64_t end);
+    static void set_thread_name(const char* name);
+
+    [[nodiscard]] static bool write_chrome_trace(const std::string& path);
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+class ProfileScope final {
+public:
+    explicit ProfileScope(const char* name)
+        : _name{name}, _start{Profiler::enabled() ? Profiler::now() : 0} {}
+    ~ProfileScope() {
+        if (_start != 0) {
+            Profiler::record(_name, _start, Profiler::now());
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* _name;
+    uint64_t _start;
+};
+
+class FrameStats final {
+public:
+    explicit FrameStats(unsigned int interval = 0);
+
+    void set_interval(unsigned int interval) { _interval = interval; }
+    // 有目标帧时间时额外报告相对目标的最大偏差。
+    void set_target(float frame_time) { _target = frame_time; }
+    void add(float frame_time);
+
+private:
+    void flush();
+
+    unsigned int _interval;
+    unsigned int _count;
+    double _sum;
+    double _sum_sq;
+    float _min;
+    float _max;
+    float _target;
+    float _max_deviation;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// C++17 没有 std::span，这里只保留需要的部分：不拥有内存的连续视图。
+template <typename T>
+class Span {
+public:
+    constexpr Span() : _data{nullptr}, _size{0} {}
+    constexpr Span(T* data, size_t size) : _data{data}, _size{size} {}
+
+    template <typename U, typename Allocator,
+              typename = std::enable_if_t<
+                  std::is_same_v<std::remove_const_t<T>, U>>>
+    Span(const std::vector<U, Allocator>& v)
+        : _data{v.data()}, _size{v.size()} {}
+
+    template <typename U, typename Allocator,
+              typename = std::enable_if_t<std::is_same_v<T, U>>>
+    Span(std::vector<U, Allocator>& v) : _data{v.data()}, _size{v.size()} {}
+
+    constexpr T* data() const { return _data; }
+    constexpr size_t size() const { return _size; }
+    constexpr bool empty() const { return _size == 0; }
+
+    constexpr T* begin() const { return _data; }
+    constexpr T* end() const { return _data + _size; }
+
+    constexpr T& operator[](size_t index) const { return _data[index]; }
+
+private:
+    T* _data;
+    size_t _size;
+};
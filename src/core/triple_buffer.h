@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// 单生产者单消费者的三缓冲：写端总有一块私有缓冲可写，读端总能拿到最近一次
+// 发布的完整数据，两边都不会等待对方。中间缓冲的下标和“有新数据”标记打包在
+// 一个原子字节里，交换只需一次 exchange。
+template <typename T>
+class TripleBuffer final {
+public:
+    TripleBuffer() : _state{1}, _front{0}, _back{2} {}
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer(TripleBuffer&&) = delete;
+
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(TripleBuffer&&) = delete;
+
+    // 写端
+    T& write_buffer() { return _buffers[_back]; }
+    void publish() {
+        uint8_t old = _state.exchange(_back | DIRTY, std::memory_order_acq_rel);
+        _back = old & INDEX_MASK;
+    }
+
+    // 读端，返回 false 表示没有新数据，read_buffer() 仍是上一次的内容。
+    bool acquire() {
+        if ((_state.load(std::memory_order_relaxed) & DIRTY) == 0) {
+            return false;
+        }
+        uint8_t old = _state.exchange(_front, std::memory_order_acq_rel);
+        _front = old & INDEX_MASK;
+        return true;
+    }
+    const T& read_buffer() const { return _buffers[_front]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    T _buffers[3];
+    std::atomic<uint8_t> _state;
+    uint8_t _front;
+    uint8_t _back;
+};
@@ -1,8 +1,19 @@
 #include "app/app.h"
+#include "app/app_config.h"
+#include "core/log.h"
 #include "scene/test_scene.h"
 
-int main() {
-    App app;
-    app.run(new TestScene());
+int main(int argc, char** argv) {
+    AppConfig config;
+    if (!parse_app_args(argc, argv, config)) {
+        return 1;
+    }
+
+    {
+        App app(config);
+        app.run(new TestScene());
+    }
+
+    shutdown_logging();
     return 0;
 }
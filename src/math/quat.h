@@ -191,7 +191,7 @@ inline Quat look_rotation(const Vec3& direction, const Vec3& up) {
     Vec3 r = cross(u, f);
     u = cross(f, r);
 
-    Quat world_to_object = from_to(Vec3(0.0f, 0.0f, -1.0f), f);
+    Quat world_to_object = from_to(Vec3(0.0f, 0.0f, 1.0f), f);
     Vec3 object_up = world_to_object * Vec3(0.0f, 1.0f, 0.0f);
     Quat u2u = from_to(object_up, u);
 
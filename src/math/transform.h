@@ -22,7 +22,7 @@ inline Transform combine(const Transform& t1, const Transform& t2) {
     Vec3 position = t1.rotation * (t1.scale * t2.position);
     position += t1.position;
 
-    return Transform(scale, rotation, position);
+    return Transform(position, rotation, scale);
 }
 
 inline Transform inverse(const Transform& t) {
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../anim/pose.h"
+#include "../math/mat4.h"
+#include "../math/vec3.h"
+
+struct SnapshotCamera {
+    Mat4 view;
+    Mat4 projection;
+    Vec3 position;
+};
+
+// 一次模拟结果的只读副本，由模拟线程写入，渲染线程只读。
+// 缓冲会被反复复用，场景填充时应当 resize 而不是重新构造，以保留已有容量。
+struct FrameSnapshot {
+    uint64_t frame = 0;
+    float alpha = 1.0f;
+
+    // 生成快照的场景代数，切换场景后旧场景的快照不会交给新场景渲染。
+    uint32_t scene = 0;
+
+    SnapshotCamera camera;
+    std::vector<Pose> poses;
+
+    // 所有角色的蒙皮矩阵首尾相接，palette_offsets[i] 是第 i 个角色的起始下标。
+    std::vector<Mat4> matrix_palettes;
+    std::vector<uint32_t> palette_offsets;
+};
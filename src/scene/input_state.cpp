@@ -0,0 +1,109 @@
+#include "input_state.h"
+
+#include <algorithm>
+
+InputState::InputState()
+    : _mouse_x{0.0f}, _mouse_y{0.0f}, _mouse_dx{0.0f}, _mouse_dy{0.0f},
+      _wheel_x{0.0f}, _wheel_y{0.0f}, _mouse_down{0}, _mouse_pressed{0},
+      _mouse_released{0}, _gamepad_connected{false}, _gamepad_id{0},
+      _gamepad_down{0}, _gamepad_pressed{0}, _gamepad_released{0},
+      _axes{} {}
+
+void InputState::begin_frame() {
+    _keys_pressed.reset();
+    _keys_released.reset();
+
+    _mouse_dx = 0.0f;
+    _mouse_dy = 0.0f;
+    _wheel_x = 0.0f;
+    _wheel_y = 0.0f;
+    _mouse_pressed = 0;
+    _mouse_released = 0;
+
+    _gamepad_pressed = 0;
+    _gamepad_released = 0;
+}
+
+void InputState::process(const SDL_Event& event) {
+    switch (event.type) {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP: {
+            int key = event.key.scancode;
+            if (key < 0 || key >= SDL_SCANCODE_COUNT || event.key.repeat) {
+                break;
+            }
+            // 同一帧内按下又松开时两个边沿都保留，短按不会丢。
+            _keys_down.set(key, event.key.down);
+            if (event.key.down) {
+                _keys_pressed.set(key);
+            } else {
+                _keys_released.set(key);
+            }
+            break;
+        }
+        case SDL_EVENT_MOUSE_MOTION:
+            _mouse_x = event.motion.x;
+            _mouse_y = event.motion.y;
+            _mouse_dx += event.motion.xrel;
+            _mouse_dy += event.motion.yrel;
+            break;
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP: {
+            uint32_t bit = mouse_bit(event.button.button);
+            _mouse_x = event.button.x;
+            _mouse_y = event.button.y;
+            if (event.button.down) {
+                _mouse_down |= bit;
+                _mouse_pressed |= bit;
+            } else {
+                _mouse_down &= ~bit;
+                _mouse_released |= bit;
+            }
+            break;
+        }
+        case SDL_EVENT_MOUSE_WHEEL:
+            _wheel_x += event.wheel.x;
+            _wheel_y += event.wheel.y;
+            break;
+        case SDL_EVENT_GAMEPAD_ADDED:
+            if (!_gamepad_connected) {
+                _gamepad_connected = true;
+                _gamepad_id = event.gdevice.which;
+            }
+            break;
+        case SDL_EVENT_GAMEPAD_REMOVED:
+            if (_gamepad_connected && event.gdevice.which == _gamepad_id) {
+                _gamepad_connected = false;
+                _gamepad_released |= _gamepad_down;
+                _gamepad_down = 0;
+                std::fill(std::begin(_axes), std::end(_axes), 0.0f);
+            }
+            break;
+        case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
+        case SDL_EVENT_GAMEPAD_BUTTON_UP: {
+            if (!_gamepad_connected || event.gbutton.which != _gamepad_id) {
+                break;
+            }
+            uint32_t bit = gamepad_bit(event.gbutton.button);
+            if (event.gbutton.down) {
+                _gamepad_down |= bit;
+                _gamepad_pressed |= bit;
+            } else {
+                _gamepad_down &= ~bit;
+                _gamepad_released |= bit;
+            }
+            break;
+        }
+        case SDL_EVENT_GAMEPAD_AXIS_MOTION:
+            if (!_gamepad_connected || event.gaxis.which != _gamepad_id ||
+                event.gaxis.axis >= SDL_GAMEPAD_AXIS_COUNT) {
+                break;
+            }
+            _axes[event.gaxis.axis] =
+                std::max(static_cast<float>(event.gaxis.value) / 32767.0f,
+                         -1.0f);
+            break;
+        default:
+            break;
+    }
+}
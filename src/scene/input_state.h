@@ -0,0 +1,85 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_gamepad.h>
+#include <SDL3/SDL_scancode.h>
+
+// 一帧的输入汇总：持续状态加上本帧的按下/松开边沿，场景不必逐个解析事件。
+// 手柄只跟踪最先接入的一个。
+class InputState {
+public:
+    InputState();
+
+    // 清除上一帧的边沿和相对量，持续状态保留。
+    void begin_frame();
+    void process(const SDL_Event& event);
+
+    bool key_down(SDL_Scancode key) const { return _keys_down.test(key); }
+    bool key_pressed(SDL_Scancode key) const { return _keys_pressed.test(key); }
+    bool key_released(SDL_Scancode key) const {
+        return _keys_released.test(key);
+    }
+
+    float mouse_x() const { return _mouse_x; }
+    float mouse_y() const { return _mouse_y; }
+    float mouse_dx() const { return _mouse_dx; }
+    float mouse_dy() const { return _mouse_dy; }
+    float wheel_x() const { return _wheel_x; }
+    float wheel_y() const { return _wheel_y; }
+
+    // button 为 SDL_BUTTON_LEFT 等，从 1 开始。
+    bool mouse_down(uint8_t button) const {
+        return _mouse_down & mouse_bit(button);
+    }
+    bool mouse_pressed(uint8_t button) const {
+        return _mouse_pressed & mouse_bit(button);
+    }
+    bool mouse_released(uint8_t button) const {
+        return _mouse_released & mouse_bit(button);
+    }
+
+    bool gamepad_connected() const { return _gamepad_connected; }
+    bool gamepad_down(SDL_GamepadButton button) const {
+        return _gamepad_down & gamepad_bit(button);
+    }
+    bool gamepad_pressed(SDL_GamepadButton button) const {
+        return _gamepad_pressed & gamepad_bit(button);
+    }
+    bool gamepad_released(SDL_GamepadButton button) const {
+        return _gamepad_released & gamepad_bit(button);
+    }
+    // 归一化到 [-1, 1]，扳机为 [0, 1]。
+    float gamepad_axis(SDL_GamepadAxis axis) const { return _axes[axis]; }
+
+private:
+    static uint32_t mouse_bit(uint8_t button) {
+        return button > 0 && button <= 32 ? 1u << (button - 1) : 0u;
+    }
+    static uint32_t gamepad_bit(int button) {
+        return button >= 0 && button < 32 ? 1u << button : 0u;
+    }
+
+    std::bitset<SDL_SCANCODE_COUNT> _keys_down;
+    std::bitset<SDL_SCANCODE_COUNT> _keys_pressed;
+    std::bitset<SDL_SCANCODE_COUNT> _keys_released;
+
+    float _mouse_x;
+    float _mouse_y;
+    float _mouse_dx;
+    float _mouse_dy;
+    float _wheel_x;
+    float _wheel_y;
+    uint32_t _mouse_down;
+    uint32_t _mouse_pressed;
+    uint32_t _mouse_released;
+
+    bool _gamepad_connected;
+    SDL_JoystickID _gamepad_id;
+    uint32_t _gamepad_down;
+    uint32_t _gamepad_pressed;
+    uint32_t _gamepad_released;
+    float _axes[SDL_GAMEPAD_AXIS_COUNT];
+};
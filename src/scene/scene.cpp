@@ -1,34 +1,224 @@
 #include "scene.h"
 
-void SceneHandler::switch_scene(SceneBase* new_scene) {
-    if (_cur_scene) {
-        _cur_scene->on_exit();
+#include <spdlog/spdlog.h>
+
+#include "../core/alloc_tracker.h"
+#include "../core/profiler.h"
+
+namespace {
+
+void load_scene(void* data, uint32_t, uint32_t) {
+    ANIM_PROFILE_SCOPE("SceneBase::on_load");
+    static_cast<SceneBase*>(data)->on_load();
+}
+
+void update_scene(void* data, uint32_t, uint32_t) {
+    const auto* context = static_cast<const UpdateContext*>(data);
+    SceneBase* scene = context->scenes->layer_scene(context->layer);
+
+    ANIM_PROFILE_SCOPE("SceneBase::on_update");
+    scene->on_update(*context);
+}
+
+} // namespace
+
+SceneHandler::SceneHandler(JobSystem* jobs, AssetLoader* assets,
+                           AssetRegistry* registry)
+    : _jobs{jobs}, _assets{assets}, _registry{registry} {}
+
+void SceneHandler::switch_scene(SceneBase* new_scene, SceneLayer layer) {
+    Layer& target = get_layer(layer);
+    wait_load(target);
+
+    std::unique_ptr<SceneBase> scene(new_scene);
+    if (scene) {
+        ANIM_PROFILE_SCOPE("SceneBase::on_load");
+        scene->on_load();
+    }
+    replace_scene(target, std::move(scene));
+}
+
+void SceneHandler::switch_scene_async(SceneBase* new_scene, SceneLayer layer) {
+    Layer& target = get_layer(layer);
+    if (target.next_scene) {
+        // 已经在加载的场景还没进入过，不需要 on_exit，等它的任务结束后丢弃。
+        spdlog::warn("scene switch requested while loading, "
+                     "previous request dropped.");
+        wait_load(target);
+    }
+    target.next_scene.reset(new_scene);
+
+    if (!_jobs) {
+        load_scene(target.next_scene.get(), 0, 0);
+        return;
+    }
+
+    Job job{};
+    job.function = load_scene;
+    job.data = target.next_scene.get();
+    job.counter = &target.load_counter;
+    // 走后台队列，帧内的 wait 不会把加载拉到模拟线程或主线程上执行。
+    _jobs->run_background(job);
+}
+
+bool SceneHandler::finish_switch() {
+    bool switched = false;
+    for (Layer& layer : _layers) {
+        if (layer.next_scene && layer.load_counter.done()) {
+            replace_scene(layer, std::move(layer.next_scene));
+            switched = true;
+        }
+    }
+    return switched;
+}
+
+bool SceneHandler::loading() const {
+    for (const Layer& layer : _layers) {
+        if (layer.next_scene) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SceneHandler::asset_loaded(AssetLoadHandle handle,
+                                const AssetFile* file) {
+    for (Layer& layer : _layers) {
+        if (layer.scene) {
+            ANIM_PROFILE_SCOPE("SceneBase::on_asset_loaded");
+            layer.scene->on_asset_loaded(handle, file);
+        }
     }
-    _cur_scene.reset(new_scene);
-    _cur_scene->on_enter();
 }
 
-void SceneHandler::handle_events(const SDL_Event& event) {
-    if (_cur_scene) {
-        _cur_scene->on_handle_events(event);
+void SceneHandler::replace_scene(Layer& layer,
+                                 std::unique_ptr<SceneBase> scene) {
+    if (layer.scene) {
+        ANIM_PROFILE_SCOPE("SceneBase::on_exit");
+        layer.scene->on_exit();
+    }
+    layer.scene = std::move(scene);
+    ++layer.generation;
+
+    if (layer.scene) {
+        ANIM_PROFILE_SCOPE("SceneBase::on_enter");
+        layer.scene->on_enter();
     }
 }
 
-void SceneHandler::update(float dt) {
-    if (_cur_scene) {
-        _cur_scene->on_update(dt);
+void SceneHandler::wait_load(Layer& layer) {
+    if (layer.next_scene && _jobs) {
+        _jobs->wait(layer.load_counter);
+    }
+    layer.next_scene = nullptr;
+}
+
+void SceneHandler::handle_events(Span<const SDL_Event> events,
+                                 const InputState& input) {
+    for (Layer& layer : _layers) {
+        if (updating(layer)) {
+            ANIM_PROFILE_SCOPE("SceneBase::on_handle_events");
+            layer.scene->on_handle_events(events, input);
+        }
+    }
+}
+
+void SceneHandler::update(float dt, FrameArena& arena) {
+    ANIM_NO_ALLOC_SCOPE("SceneHandler::update");
+
+    size_t active = 0;
+    for (size_t i = 0; i < SCENE_LAYER_COUNT; ++i) {
+        Layer& layer = _layers[i];
+        layer.context = UpdateContext{dt, _jobs, _assets, _registry,
+                                      &arena, this, static_cast<SceneLayer>(i)};
+        if (updating(layer)) {
+            ++active;
+        }
+    }
+
+    // 只有一层时没有并行的必要，省掉任务的派发和等待。
+    bool parallel = _jobs && active > 1;
+    JobCounter counter;
+    for (Layer& layer : _layers) {
+        if (!updating(layer)) {
+            continue;
+        }
+        if (!parallel ||
+            layer.flags.load(std::memory_order_relaxed) & SCENE_LAYER_SERIAL) {
+            continue;
+        }
+
+        Job job{};
+        job.function = update_scene;
+        job.data = &layer.context;
+        job.counter = &counter;
+        _jobs->run(job);
+    }
+
+    // 串行层与其他层共享状态，要等并行的层全部更新完再在调用线程上更新。
+    if (parallel) {
+        _jobs->wait(counter);
+    }
+
+    for (Layer& layer : _layers) {
+        if (updating(layer) &&
+            (!parallel || layer.flags.load(std::memory_order_relaxed) &
+                              SCENE_LAYER_SERIAL)) {
+            update_scene(&layer.context, 0, 0);
+        }
+    }
+}
+
+void SceneHandler::publish(uint64_t frame, float alpha) {
+    for (Layer& layer : _layers) {
+        if (!updating(layer)) {
+            continue;
+        }
+
+        FrameSnapshot& snapshot = layer.snapshots.write_buffer();
+        snapshot.frame = frame;
+        snapshot.alpha = alpha;
+        snapshot.scene = layer.generation;
+        {
+            ANIM_PROFILE_SCOPE("SceneBase::on_snapshot");
+            layer.scene->on_snapshot(snapshot);
+        }
+        layer.snapshots.publish();
     }
 }
 
 void SceneHandler::render() {
-    if (_cur_scene) {
-        _cur_scene->on_render();
+    ANIM_NO_ALLOC_SCOPE("SceneHandler::render");
+
+    for (Layer& layer : _layers) {
+        if (!layer.scene ||
+            layer.flags.load(std::memory_order_relaxed) &
+                SCENE_LAYER_PAUSE_RENDER) {
+            continue;
+        }
+
+        // 暂停更新的层不再发布快照，继续画最后一帧。
+        layer.snapshots.acquire();
+        const FrameSnapshot& snapshot = layer.snapshots.read_buffer();
+        if (snapshot.scene != layer.generation) {
+            continue;
+        }
+
+        ANIM_PROFILE_SCOPE("SceneBase::on_render");
+        layer.scene->on_render(snapshot);
     }
 }
 
 void SceneHandler::clean() {
-    if (_cur_scene) {
-        _cur_scene->on_exit();
-        _cur_scene = nullptr;
+    // 从上层往下退出，和进入的顺序相反。
+    for (size_t i = SCENE_LAYER_COUNT; i-- > 0;) {
+        Layer& layer = _layers[i];
+        wait_load(layer);
+
+        if (layer.scene) {
+            ANIM_PROFILE_SCOPE("SceneBase::on_exit");
+            layer.scene->on_exit();
+            layer.scene = nullptr;
+        }
     }
 }
@@ -1,23 +1,79 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 #include <SDL3/SDL_events.h>
 
+#include "../asset/asset_loader.h"
+#include "../asset/asset_registry.h"
+#include "../core/job_system.h"
+#include "../core/span.h"
+#include "../core/triple_buffer.h"
+#include "frame_snapshot.h"
+#include "input_state.h"
+
+class FrameArena;
+class SceneHandler;
+
+// 按渲染顺序排列。不同层之间不共享可变状态，更新时可以并行。
+enum class SceneLayer : uint8_t {
+    Background,
+    World,
+    Ui,
+    Debug,
+    Count,
+};
+
+constexpr size_t SCENE_LAYER_COUNT = static_cast<size_t>(SceneLayer::Count);
+
+enum SceneLayerFlags : uint32_t {
+    SCENE_LAYER_PAUSE_UPDATE = 1u << 0,
+    SCENE_LAYER_PAUSE_RENDER = 1u << 1,
+    // 与其他层共享状态时设置，这一层等并行的层更新完后在调用线程上更新。
+    SCENE_LAYER_SERIAL = 1u << 2,
+};
+
+// arena 中的内存在本帧渲染结束前一直有效，之后会被下一帧复用。
+struct UpdateContext {
+    float dt;
+    JobSystem* jobs;
+    AssetLoader* assets;
+    AssetRegistry* registry;
+    FrameArena* arena;
+    SceneHandler* scenes;
+    SceneLayer layer;
+};
+
+// 流水线模式下 on_handle_events / on_update / on_snapshot 在模拟线程调用，
+// on_render 在持有 GL 上下文的主线程调用，只能读取快照，不能访问场景状态。
 class SceneBase {
 public:
     virtual ~SceneBase() = default;
 
+    // 在工作线程执行，用来读文件、解码资源，不能调用 GL，也不能碰当前场景。
+    virtual void on_load() {}
+    // 在主线程执行，on_load 之后调用，适合做 GL 上传这类短小的收尾工作。
     virtual void on_enter() {}
-    virtual void on_handle_events(const SDL_Event&) {}
-    virtual void on_update(float) {}
-    virtual void on_render() {}
+    // 每帧调用一次，events 为本帧的全部事件，input 已经处理过这些事件。
+    virtual void on_handle_events(Span<const SDL_Event>, const InputState&) {}
+    virtual void on_update(const UpdateContext&) {}
+    virtual void on_snapshot(FrameSnapshot&) {}
+    virtual void on_render(const FrameSnapshot&) {}
+    // 在主线程的帧边界调用，此时没有其他场景回调在执行，可以修改场景状态，
+    // 也可以上传 GL 资源。所有层都会收到，场景自己比对句柄，失败时 file 为空。
+    // 开启热重载时同一个句柄会再次回调，file 地址不变但内容已换成新版本，
+    // 旧数据在回调返回后释放，快照里不要直接引用资源内存。
+    virtual void on_asset_loaded(AssetLoadHandle, const AssetFile*) {}
     virtual void on_exit() {}
 };
 
 class SceneHandler final {
 public:
-    SceneHandler() = default;
+    explicit SceneHandler(JobSystem* jobs, AssetLoader* assets = nullptr,
+                          AssetRegistry* registry = nullptr);
     ~SceneHandler() = default;
     SceneHandler(const SceneHandler&) = delete;
     SceneHandler(SceneHandler&&) = delete;
@@ -25,13 +81,69 @@ public:
     SceneHandler& operator=(const SceneHandler&) = delete;
     SceneHandler& operator=(SceneHandler&&) = delete;
 
-    void switch_scene(SceneBase* new_scene);
+    // 同步切换：on_load、旧场景 on_exit、新场景 on_enter 依次在调用线程完成。
+    // new_scene 为空时清空这一层。
+    void switch_scene(SceneBase* new_scene,
+                      SceneLayer layer = SceneLayer::World);
+    // 异步切换：on_load 交给任务系统的后台队列，当前场景照常更新和渲染，
+    // 加载完成后由 finish_switch 在帧边界完成替换。
+    // 各层并行更新时，场景只能切换自己所在的层。
+    void switch_scene_async(SceneBase* new_scene,
+                            SceneLayer layer = SceneLayer::World);
+    // 只能在主线程、且没有场景回调在执行时调用，返回是否发生了切换。
+    bool finish_switch();
+    bool loading() const;
+    // 与 finish_switch 的调用约束相同，把加载完成的资源转发给各层场景。
+    void asset_loaded(AssetLoadHandle handle, const AssetFile* file);
 
-    void handle_events(const SDL_Event& event);
-    void update(float dt);
+    uint32_t layer_flags(SceneLayer layer) const {
+        return get_layer(layer).flags.load(std::memory_order_relaxed);
+    }
+    void set_layer_flags(SceneLayer layer, uint32_t flags) {
+        get_layer(layer).flags.store(flags, std::memory_order_relaxed);
+    }
+
+    SceneBase* layer_scene(SceneLayer layer) const {
+        return get_layer(layer).scene.get();
+    }
+
+    void handle_events(Span<const SDL_Event> events, const InputState& input);
+    void update(float dt, FrameArena& arena);
+    void publish(uint64_t frame, float alpha);
     void render();
     void clean();
 
 private:
-    std::unique_ptr<SceneBase> _cur_scene;
+    struct Layer {
+        std::unique_ptr<SceneBase> scene;
+        uint32_t generation = 0;
+        std::atomic<uint32_t> flags{0};
+        TripleBuffer<FrameSnapshot> snapshots;
+
+        std::unique_ptr<SceneBase> next_scene;
+        JobCounter load_counter;
+
+        // 并行更新时传给任务的参数。
+        UpdateContext context{};
+    };
+
+    Layer& get_layer(SceneLayer layer) {
+        return _layers[static_cast<size_t>(layer)];
+    }
+    const Layer& get_layer(SceneLayer layer) const {
+        return _layers[static_cast<size_t>(layer)];
+    }
+
+    bool updating(const Layer& layer) const {
+        return layer.scene && (layer.flags.load(std::memory_order_relaxed) &
+                               SCENE_LAYER_PAUSE_UPDATE) == 0;
+    }
+
+    void replace_scene(Layer& layer, std::unique_ptr<SceneBase> scene);
+    void wait_load(Layer& layer);
+
+    JobSystem* _jobs;
+    AssetLoader* _assets;
+    AssetRegistry* _registry;
+    Layer _layers[SCENE_LAYER_COUNT];
 };
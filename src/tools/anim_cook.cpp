@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "../asset/mapped_file.h"
+#include "../asset/pack_file.h"
+#include "../core/job_system.h"
+#include "../core/log.h"
+#include "asset_cooker.h"
+#include "cook_manifest.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* COOK_OUTPUT_EXTENSION = ".anim";
+constexpr const char* COOK_MANIFEST_NAME = "anim_cook.manifest";
+
+struct CookOptions {
+    std::string input_dir;
+    std::string output_dir;
+    std::string manifest_path;
+    std::string pack_path;
+    PackCompression pack_compression = PackCompression::Lz;
+    bool force = false;
+    unsigned int worker_count = 0;
+    CookSettings settings;
+};
+
+enum class CookStatus {
+    Skipped,
+    Cooked,
+    Failed,
+};
+
+struct CookTask {
+    // 相对输入目录的路径，同时作为清单中的键。
+    std::string key;
+    std::string input;
+    std::string output;
+    CookStatus status = CookStatus::Failed;
+    CookManifestEntry entry;
+    CookStats stats;
+};
+
+void print_usage() {
+    std::printf(
+        "usage: anim_cook <input dir> <output dir> [options]\n"
+        "  --force             cook every input, ignoring the manifest\n"
+        "  --workers <n>       worker threads, 0 = one per core\n"
+        "  --manifest <path>   default: <output dir>/%s\n"
+        "  --pack <path>       also bundle every output into one pack file\n"
+        "  --pack-store        store pack entries uncompressed\n"
+        "  --max-error <m>     keyframe reduction tolerance in meters\n"
+        "  --sample-rate <hz>  compressed clip sample rate\n"
+        "  --no-reduce         skip keyframe reduction\n"
+        "  --no-reorder        keep the source joint order, parents must\n"
+        "                      come before their children\n",
+        COOK_MANIFEST_NAME);
+}
+
+bool parse_uint(const char* text, unsigned int& out) {
+    char* end = nullptr;
+    unsigned long value = std::strtoul(text, &end, 10);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    out = static_cast<unsigned int>(value);
+    return true;
+}
+
+bool parse_float(const char* text, float& out) {
+    char* end = nullptr;
+    float value = std::strtof(text, &end);
+    if (end == text || *end != '\0' || value < 0.0f) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+bool parse_cook_args(int argc, char** argv, CookOptions& options) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        float value = 0.0f;
+
+        if (arg == "--force") {
+            options.force = true;
+        } else if (arg == "--workers" && has_value &&
+                   parse_uint(argv[i + 1], options.worker_count)) {
+            ++i;
+        } else if (arg == "--manifest" && has_value) {
+            options.manifest_path = argv[i + 1];
+            ++i;
+        } else if (arg == "--pack" && has_value) {
+            options.pack_path = argv[i + 1];
+            ++i;
+        } else if (arg == "--pack-store") {
+            options.pack_compression = PackCompression::None;
+        } else if (arg == "--max-error" && has_value &&
+                   parse_float(argv[i + 1], value)) {
+            options.settings.optimizer.max_error = value;
+            ++i;
+        } else if (arg == "--sample-rate" && has_value &&
+                   parse_float(argv[i + 1], value) && value > 0.0f) {
+            options.settings.compression.sample_rate = value;
+            ++i;
+        } else if (arg == "--no-reduce") {
+            options.settings.reduce_keys = false;
+        } else if (arg == "--no-reorder") {
+            options.settings.reorder_joints = false;
+        } else if (!arg.empty() && arg[0] != '-') {
+            positional.push_back(arg);
+        } else {
+            spdlog::error("unknown or incomplete argument: {}", arg);
+            return false;
+        }
+    }
+
+    if (positional.size() != 2) {
+        return false;
+    }
+    options.input_dir = positional[0];
+    options.output_dir = positional[1];
+    if (options.manifest_path.empty()) {
+        options.manifest_path =
+            (fs::path(options.output_dir) / COOK_MANIFEST_NAME).string();
+    }
+    return true;
+}
+
+bool is_source_asset(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return extension == ".gltf" || extension == ".glb";
+}
+
+bool collect_tasks(const CookOptions& options, std::vector<CookTask>& out) {
+    std::error_code error;
+    fs::recursive_directory_iterator it(options.input_dir, error);
+    if (error) {
+        spdlog::error("open input directory failed: {}", options.input_dir);
+        return false;
+    }
+
+    for (; it != fs::recursive_directory_iterator(); it.increment(error)) {
+        if (error) {
+            spdlog::error("scan input directory failed: {}", error.message());
+            return false;
+        }
+        if (!it->is_regular_file() || !is_source_asset(it->path())) {
+            continue;
+        }
+
+        fs::path relative = it->path().lexically_relative(options.input_dir);
+        CookTask task;
+        task.key = relative.generic_string();
+        task.input = it->path().string();
+        task.output = (fs::path(options.output_dir) / relative)
+                          .replace_extension(COOK_OUTPUT_EXTENSION)
+                          .string();
+        out.push_back(std::move(task));
+    }
+
+    // 按输出排序以便发现重名，例如同一目录下的 a.gltf 和 a.glb。
+    std::sort(out.begin(), out.end(), [](const CookTask& a, const CookTask& b) {
+        return a.output < b.output;
+    });
+    for (size_t i = 1; i < out.size(); ++i) {
+        if (out[i].output == out[i - 1].output) {
+            spdlog::error("{} and {} both cook to {}.", out[i - 1].key,
+                          out[i].key, out[i].output);
+            return false;
+        }
+    }
+    return true;
+}
+
+void run_task(CookTask& task, const CookOptions& options,
+              const CookManifest& manifest, uint64_t settings_hash,
+              JobSystem& jobs) {
+    // 清单里的依赖路径相对输入目录，换个工作目录运行也能命中。
+    fs::path root(options.input_dir);
+    std::vector<std::string> previous_dependencies;
+    const CookManifestEntry* previous = manifest.find(task.key);
+    if (previous) {
+        for (const std::string& dependency : previous->dependencies) {
+            previous_dependencies.push_back((root / dependency).string());
+        }
+    }
+
+    uint64_t hash = 0;
+    bool hashed = previous && hash_cook_inputs(task.input,
+                                               previous_dependencies,
+                                               settings_hash, hash);
+    if (!options.force && hashed && hash == previous->hash &&
+        fs::exists(task.output)) {
+        task.status = CookStatus::Skipped;
+        task.entry = *previous;
+        return;
+    }
+
+    std::vector<std::string> dependencies;
+    if (!cook_gltf(task.input, task.output, options.settings, jobs,
+                   dependencies, task.stats)) {
+        task.status = CookStatus::Failed;
+        return;
+    }
+
+    // 依赖没变时直接沿用转换前算好的哈希，否则按新的依赖重新计算。
+    if (!hashed || dependencies != previous_dependencies) {
+        hashed = hash_cook_inputs(task.input, dependencies, settings_hash,
+                                  hash);
+    }
+    task.entry.hash = hashed ? hash : 0;
+    task.entry.dependencies.clear();
+    for (const std::string& dependency : dependencies) {
+        task.entry.dependencies.push_back(
+            fs::path(dependency).lexically_relative(root).generic_string());
+    }
+    task.status = CookStatus::Cooked;
+}
+
+bool write_pack(const std::vector<CookTask>& tasks, const CookOptions& options,
+                JobSystem& jobs) {
+    // 条目名是相对输出目录的路径，和单独发布时的文件布局一致。
+    PackWriter writer;
+    for (const CookTask& task : tasks) {
+        MappedFile file;
+        if (!file.open(task.output)) {
+            return false;
+        }
+        std::string name = fs::path(task.output)
+                               .lexically_relative(options.output_dir)
+                               .generic_string();
+        if (!writer.add(name, std::vector<uint8_t>(
+                                  file.data(), file.data() + file.size()))) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::string temp = options.pack_path + ".tmp";
+    if (!writer.write(temp, &jobs, options.pack_compression)) {
+        return false;
+    }
+    fs::rename(temp, options.pack_path, error);
+    if (error) {
+        spdlog::error("replace pack file failed: {}", options.pack_path);
+        fs::remove(temp, error);
+        return false;
+    }
+    spdlog::info("packed {} assets into {}, {} bytes.", tasks.size(),
+                 options.pack_path, fs::file_size(options.pack_path, error));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CookOptions options;
+    if (!parse_cook_args(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    LogSettings log_settings;
+    // 离线工具不在乎日志的延迟，任何一条都不能丢。
+    log_settings.overflow = LogOverflow::Block;
+    if (!init_logging(log_settings)) {
+        return 1;
+    }
+
+    std::vector<CookTask> tasks;
+    JobSystem jobs;
+    int result = 1;
+    if (collect_tasks(options, tasks) && jobs.init(options.worker_count)) {
+        CookManifest manifest;
+        if (!options.force) {
+            manifest.load(options.manifest_path);
+        }
+
+        uint64_t settings_hash = hash_cook_settings(options.settings);
+        auto start = std::chrono::steady_clock::now();
+        jobs.parallel_for(static_cast<uint32_t>(tasks.size()), 1,
+                          [&](uint32_t begin, uint32_t end) {
+                              for (uint32_t i = begin; i < end; ++i) {
+                                  run_task(tasks[i], options, manifest,
+                                           settings_hash, jobs);
+                              }
+                          });
+
+        // 新清单只保留这次成功的输入，失败或已删除的输入下次会重新转换。
+        CookManifest updated;
+        unsigned int counts[3] = {};
+        CookStats total;
+        for (const CookTask& task : tasks) {
+            ++counts[static_cast<int>(task.status)];
+            if (task.status != CookStatus::Failed) {
+                updated.set(task.key, task.entry);
+            }
+            total.clips += task.stats.clips;
+            total.source_keys += task.stats.source_keys;
+            total.reduced_keys += task.stats.reduced_keys;
+            total.output_bytes += task.stats.output_bytes;
+        }
+
+        fs::create_directories(options.output_dir);
+        bool saved = updated.save(options.manifest_path);
+        std::chrono::duration<double> seconds =
+            std::chrono::steady_clock::now() - start;
+        spdlog::info("cooked {}, skipped {}, failed {} in {:.2f} s.",
+                     counts[static_cast<int>(CookStatus::Cooked)],
+                     counts[static_cast<int>(CookStatus::Skipped)],
+                     counts[static_cast<int>(CookStatus::Failed)],
+                     seconds.count());
+        if (total.clips > 0) {
+            spdlog::info("{} clips, keys {} -> {}, {} bytes written.",
+                         total.clips, total.source_keys, total.reduced_keys,
+                         total.output_bytes);
+        }
+        bool failed = counts[static_cast<int>(CookStatus::Failed)] > 0;
+        // 有输入失败时不更新资源包，免得发布缺了资源的包。
+        bool packed = options.pack_path.empty() ||
+                      (!failed && write_pack(tasks, options, jobs));
+        result = saved && packed && !failed ? 0 : 1;
+    }
+
+    jobs.shutdown();
+    shutdown_logging();
+    return result;
+}
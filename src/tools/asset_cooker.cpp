@@ -0,0 +1,187 @@
+#include "asset_cooker.h"
+
+#include <filesystem>
+
+#include <spdlog/spdlog.h>
+
+#include "../asset/asset_file.h"
+#include "../core/hash.h"
+#include "../core/job_system.h"
+#include "../core/profiler.h"
+
+namespace {
+
+template <typename T>
+uint64_t hash_value(const T& value, uint64_t hash) {
+    return fnv1a64(&value, sizeof(value), hash);
+}
+
+} // namespace
+
+uint64_t hash_cook_settings(const CookSettings& settings) {
+    // 逐个字段哈希，避免把结构体的填充字节算进去。
+    uint64_t hash = hash_value(COOK_VERSION, FNV1A64_OFFSET);
+    hash = hash_value(settings.optimizer.max_error, hash);
+    hash = hash_value(settings.optimizer.shell_distance, hash);
+    hash = hash_value(settings.optimizer.validate_sample_rate, hash);
+    hash = hash_value(settings.compression.sample_rate, hash);
+    hash = hash_value(settings.compression.position_tolerance, hash);
+    hash = hash_value(settings.compression.rotation_tolerance, hash);
+    hash = hash_value(settings.compression.scale_tolerance, hash);
+    hash = hash_value(settings.reduce_keys, hash);
+    return hash_value(settings.reorder_joints, hash);
+}
+
+void reorder_joints(GltfAsset& asset) {
+    const Skeleton& skeleton = asset.skeleton;
+    const Pose& rest = skeleton.rest_pose();
+    unsigned int num_joints = skeleton.size();
+
+    std::vector<std::vector<unsigned int>> children(num_joints);
+    std::vector<unsigned int> order;
+    std::vector<unsigned int> stack;
+    order.reserve(num_joints);
+    for (unsigned int i = num_joints; i-- > 0;) {
+        int parent = rest.parent(i);
+        if (parent >= 0) {
+            children[parent].push_back(i);
+        } else {
+            stack.push_back(i);
+        }
+    }
+
+    // 子节点逆序入栈，出栈顺序与原顺序一致，已经有序的骨架保持不变。
+    while (!stack.empty()) {
+        unsigned int joint = stack.back();
+        stack.pop_back();
+        order.push_back(joint);
+        stack.insert(stack.end(), children[joint].begin(),
+                     children[joint].end());
+    }
+
+    std::vector<unsigned int> remap(num_joints);
+    bool identity = true;
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        remap[order[i]] = i;
+        identity = identity && order[i] == i;
+    }
+    if (identity) {
+        return;
+    }
+
+    const Pose& bind = skeleton.bind_pose();
+    Pose new_rest(num_joints);
+    Pose new_bind(num_joints);
+    std::vector<std::string> names(num_joints);
+    for (unsigned int i = 0; i < num_joints; ++i) {
+        unsigned int old = order[i];
+        int parent = rest.parent(old);
+        int new_parent = parent >= 0 ? static_cast<int>(remap[parent]) : -1;
+        new_rest.set_parent(i, new_parent);
+        new_bind.set_parent(i, new_parent);
+        new_rest.set_local_transform(i, rest.local_transform(old));
+        new_bind.set_local_transform(i, bind.local_transform(old));
+        names[i] = skeleton.joint_name(old);
+    }
+    asset.skeleton.set(new_rest, new_bind, names);
+
+    for (Clip& clip : asset.clips) {
+        for (unsigned int i = 0; i < clip.size(); ++i) {
+            clip.track(i).set_id(remap[clip.joint_id(i)]);
+        }
+    }
+    for (GltfMesh& mesh : asset.meshes) {
+        for (auto& joints : mesh.data.joints) {
+            for (uint16_t& joint : joints) {
+                joint = static_cast<uint16_t>(remap[joint]);
+            }
+        }
+    }
+}
+
+bool cook_gltf(const std::string& input, const std::string& output,
+               const CookSettings& settings, JobSystem& jobs,
+               std::vector<std::string>& dependencies, CookStats& stats) {
+    ANIM_PROFILE_SCOPE("cook_gltf");
+
+    GltfAsset asset;
+    if (!import_gltf(input, asset)) {
+        return false;
+    }
+    dependencies = asset.dependencies;
+
+    if (settings.reorder_joints) {
+        reorder_joints(asset);
+    } else {
+        // 运行时只接受父关节在前的骨架，不重排时源文件必须本来就有序。
+        const Pose& rest = asset.skeleton.rest_pose();
+        for (unsigned int i = 0; i < rest.size(); ++i) {
+            if (rest.parent(i) >= static_cast<int>(i)) {
+                spdlog::error("{}: joint {} comes before its parent, "
+                              "cannot cook with --no-reorder.",
+                              input, i);
+                return false;
+            }
+        }
+    }
+
+    struct ClipResult {
+        CompressedClip compressed;
+        ClipOptimizerResult reduction;
+        bool ok = false;
+    };
+    std::vector<ClipResult> results(asset.clips.size());
+    jobs.parallel_for(
+        static_cast<uint32_t>(asset.clips.size()), 1,
+        [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                ANIM_PROFILE_SCOPE("cook_clip");
+                const Clip* source = &asset.clips[i];
+                Clip reduced;
+                if (settings.reduce_keys) {
+                    results[i].reduction = optimize_clip(
+                        *source, asset.skeleton, settings.optimizer, reduced);
+                    source = &reduced;
+                }
+                results[i].ok = results[i].compressed.compress(
+                    *source, asset.skeleton, settings.compression);
+            }
+        });
+
+    AssetWriter writer;
+    std::string name = std::filesystem::path(input).stem().string();
+    writer.add_skeleton(name, asset.skeleton);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const std::string& clip_name = asset.clips[i].name();
+        // 空动画或只有一帧的动画无法按采样率压缩，跳过而不是让整个文件失败。
+        if (!results[i].ok || !writer.add_clip(clip_name,
+                                               results[i].compressed)) {
+            spdlog::warn("{}: skipped clip {} that cannot be compressed.",
+                         input, clip_name);
+            continue;
+        }
+        ++stats.clips;
+        stats.source_keys += results[i].reduction.source_keys;
+        stats.reduced_keys += results[i].reduction.optimized_keys;
+    }
+    for (const GltfMesh& mesh : asset.meshes) {
+        writer.add_mesh(mesh.name, mesh.data);
+    }
+
+    // 写到临时文件再改名，运行时不会映射到写了一半的资源。
+    std::error_code error;
+    std::filesystem::create_directories(
+        std::filesystem::path(output).parent_path(), error);
+    std::string temp = output + ".tmp";
+    if (!writer.write(temp)) {
+        return false;
+    }
+    stats.output_bytes += std::filesystem::file_size(temp, error);
+    std::filesystem::rename(temp, output, error);
+    if (error) {
+        spdlog::error("replace cook output failed: {}", output);
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    return true;
+}
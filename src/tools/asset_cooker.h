@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../anim/clip_optimizer.h"
+#include "../anim/compressed_clip.h"
+#include "../asset/gltf_importer.h"
+
+class JobSystem;
+
+// 修改转换流程或默认参数时递增，所有资源都会重新转换。
+constexpr uint32_t COOK_VERSION = 1;
+
+struct CookSettings {
+    ClipOptimizerSettings optimizer;
+    CompressedClipSettings compression;
+    bool reduce_keys = true;
+    bool reorder_joints = true;
+};
+
+struct CookStats {
+    unsigned int clips = 0;
+    unsigned int source_keys = 0;
+    unsigned int reduced_keys = 0;
+    size_t output_bytes = 0;
+};
+
+// 参与内容哈希，参数变化会让已有的输出全部失效。
+uint64_t hash_cook_settings(const CookSettings& settings);
+
+// 按深度优先重排关节，使父关节总在子关节之前、同一条骨链连续存放，
+// 并同步更新动画轨道和网格的关节索引。
+void reorder_joints(GltfAsset& asset);
+
+// 导入 glTF，精简关键帧、量化压缩后写成运行时资源。
+// 同一文件的多个动画通过任务系统并行处理。
+[[nodiscard]] bool cook_gltf(const std::string& input,
+                             const std::string& output,
+                             const CookSettings& settings, JobSystem& jobs,
+                             std::vector<std::string>& dependencies,
+                             CookStats& stats);
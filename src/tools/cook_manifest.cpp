@@ -0,0 +1,130 @@
+#include "cook_manifest.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+
+#include "../asset/mapped_file.h"
+#include "../core/hash.h"
+
+namespace {
+
+constexpr const char* MANIFEST_HEADER = "anim_cook manifest 1";
+
+} // namespace
+
+bool CookManifest::load(const std::string& path) {
+    _entries.clear();
+
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != MANIFEST_HEADER) {
+        spdlog::warn("ignoring cook manifest with unknown format: {}", path);
+        return false;
+    }
+
+    // 每行：哈希<TAB>输入<TAB>依赖 1<TAB>依赖 2...
+    while (std::getline(file, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+
+        CookManifestEntry entry;
+        if (std::sscanf(line.c_str(), "%" SCNx64, &entry.hash) != 1) {
+            continue;
+        }
+
+        size_t begin = tab + 1;
+        size_t end = line.find('\t', begin);
+        std::string input = line.substr(begin, end - begin);
+        while (end != std::string::npos) {
+            begin = end + 1;
+            end = line.find('\t', begin);
+            entry.dependencies.push_back(line.substr(begin, end - begin));
+        }
+        _entries[input] = std::move(entry);
+    }
+    return true;
+}
+
+bool CookManifest::save(const std::string& path) const {
+    // 先写临时文件再替换，中途退出不会留下半个清单。
+    std::string temp = path + ".tmp";
+    std::FILE* file = std::fopen(temp.c_str(), "w");
+    if (!file) {
+        spdlog::error("write cook manifest failed: {}", path);
+        return false;
+    }
+
+    // 按输入排序输出，清单的差异才有意义。
+    std::vector<const std::pair<const std::string, CookManifestEntry>*> sorted;
+    sorted.reserve(_entries.size());
+    for (const auto& entry : _entries) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    std::fprintf(file, "%s\n", MANIFEST_HEADER);
+    for (const auto* entry : sorted) {
+        std::fprintf(file, "%016" PRIx64 "\t%s", entry->second.hash,
+                     entry->first.c_str());
+        for (const std::string& dependency : entry->second.dependencies) {
+            std::fprintf(file, "\t%s", dependency.c_str());
+        }
+        std::fputc('\n', file);
+    }
+
+    bool ok = std::fclose(file) == 0;
+    if (ok) {
+        std::remove(path.c_str());
+        ok = std::rename(temp.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        spdlog::error("write cook manifest failed: {}", path);
+    }
+    return ok;
+}
+
+const CookManifestEntry* CookManifest::find(const std::string& input) const {
+    auto it = _entries.find(input);
+    return it != _entries.end() ? &it->second : nullptr;
+}
+
+void CookManifest::set(const std::string& input,
+                       const CookManifestEntry& entry) {
+    _entries[input] = entry;
+}
+
+bool hash_cook_inputs(const std::string& input,
+                      const std::vector<std::string>& dependencies,
+                      uint64_t seed, uint64_t& out) {
+    uint64_t hash = seed;
+    auto hash_file = [&hash](const std::string& path) {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        hash = fnv1a64(file.data(), file.size(), hash);
+        return true;
+    };
+
+    if (!hash_file(input)) {
+        return false;
+    }
+    for (const std::string& dependency : dependencies) {
+        if (!hash_file(dependency)) {
+            return false;
+        }
+    }
+    out = hash;
+    return true;
+}
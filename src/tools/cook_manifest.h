@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct CookManifestEntry {
+    // 输入文件、依赖文件和转换参数一起计算的内容哈希。
+    uint64_t hash = 0;
+    std::vector<std::string> dependencies;
+};
+
+// 记录上次成功转换时每个输入的内容哈希，哈希未变且输出仍在时跳过转换。
+// 文本格式，每行一个输入，便于在版本库外排查。
+class CookManifest {
+public:
+    bool load(const std::string& path);
+    [[nodiscard]] bool save(const std::string& path) const;
+
+    const CookManifestEntry* find(const std::string& input) const;
+    void set(const std::string& input, const CookManifestEntry& entry);
+    void erase(const std::string& input) { _entries.erase(input); }
+
+private:
+    std::unordered_map<std::string, CookManifestEntry> _entries;
+};
+
+// 依次哈希输入和依赖文件的内容，任一文件不可读时返回 false。
+bool hash_cook_inputs(const std::string& input,
+                      const std::vector<std::string>& dependencies,
+                      uint64_t seed, uint64_t& out);